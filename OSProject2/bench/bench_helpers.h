@@ -0,0 +1,19 @@
+#ifndef BENCH_HELPERS_H
+#define BENCH_HELPERS_H
+
+#include <benchmark/benchmark.h>
+
+#include "alloc_stats.h"
+
+// Helpers shared by the Google Benchmark executables
+
+// Reports the heap traffic of a benchmark's timed loop: allocations per iteration and how far the heap went above
+// what was live before the loop
+inline void report_allocations(benchmark::State &state, AllocPhase_t *phase)
+{
+    alloc_stats_end(phase);
+    state.counters["allocs"] = benchmark::Counter((double)phase->delta.allocations, benchmark::Counter::kAvgIterations);
+    state.counters["peak_bytes"] = (double)phase->delta.peak_bytes;
+}
+
+#endif
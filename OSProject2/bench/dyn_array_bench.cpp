@@ -0,0 +1,279 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <alloc_stats.h>
+#include <dyn_array.h>
+#include <utilities.h>
+
+#include "bench_helpers.h"
+
+// Micro benchmarks for the dyn_array operations the schedulers lean on, over element sizes of 4, 20 (a pcb in the
+// original layout) and 64 bytes and lengths up to 10^7. The results are printed as CSV by default so runs from two
+// builds can be diffed, pass --benchmark_format=console to read them instead.
+//
+// insert_erase/<pattern> inserts one element and erases it again so the length stays put, front and middle pay for
+//                        shifting the rest of the array and sorted also pays for insert_sorted's linear search
+// at/<pattern>           reads every element once through dyn_array_at, in order or in a shuffled order
+// sort/<pattern>         sorts the whole array, only the dyn_array_sort call is timed
+//
+// insert_erase and sort also report allocs (heap allocations per iteration) and peak_bytes (the most heap the loop
+// used on top of the array), which shows qsort's temporary buffer
+
+// An element of 'Size' bytes whose first 4 bytes hold its sort key
+template <size_t Size>
+struct element_t
+{
+    uint8_t bytes[Size];
+};
+
+template <size_t Size>
+static uint32_t element_key(const void *element)
+{
+    uint32_t key;
+    memcpy(&key, element, sizeof(key));
+    return key;
+}
+
+template <size_t Size>
+static element_t<Size> make_element(uint32_t key)
+{
+    element_t<Size> element;
+    memset(&element, 0, sizeof(element));
+    memcpy(&element, &key, sizeof(key));
+    return element;
+}
+
+template <size_t Size>
+static int compare_elements(const void *a, const void *b)
+{
+    uint32_t key_a = element_key<Size>(a);
+    uint32_t key_b = element_key<Size>(b);
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+// Builds an array of 'length' elements with keys 0, 2, 4, ... so an odd key always has a unique sorted position
+template <size_t Size>
+static dyn_array_t *make_array(size_t length)
+{
+    std::vector<element_t<Size>> elements(length);
+    for (size_t i = 0; i < length; i++)
+    {
+        elements[i] = make_element<Size>((uint32_t)(2 * i));
+    }
+    // Spare room so inserting one more never reallocates inside the timed loop
+    dyn_array_t *array = dyn_array_create(length + 16, Size, NULL);
+    if (array != NULL && length > 0)
+    {
+        memcpy(array->array, elements.data(), length * Size);
+        array->size = length;
+    }
+    return array;
+}
+
+enum pattern_t
+{
+    PATTERN_FRONT,
+    PATTERN_MIDDLE,
+    PATTERN_BACK,
+    PATTERN_SORTED,
+    PATTERN_REVERSED,
+    PATTERN_SHUFFLED,
+};
+
+template <size_t Size>
+static void BM_insert_erase(benchmark::State &state, pattern_t pattern)
+{
+    size_t length = (size_t)state.range(0);
+    dyn_array_t *array = make_array<Size>(length);
+    if (array == NULL)
+    {
+        state.SkipWithError("could not create the array");
+        return;
+    }
+    uint64_t seed = 42; // Fixed so every build benchmarks the same data
+    element_t<Size> element = make_element<Size>(1);
+    AllocPhase_t phase;
+    alloc_stats_begin(&phase, "insert_erase");
+    for (auto _ : state)
+    {
+        bool success;
+        switch (pattern)
+        {
+        case PATTERN_FRONT:
+            success = dyn_array_push_front(array, &element) && dyn_array_erase(array, 0);
+            break;
+        case PATTERN_MIDDLE:
+            success = dyn_array_insert(array, length / 2, &element) && dyn_array_erase(array, length / 2);
+            break;
+        case PATTERN_BACK:
+            success = dyn_array_push_back(array, &element) && dyn_array_pop_back(array);
+            break;
+        default:
+        {
+            // A random odd key lands right after the even key below it
+            uint32_t key = 2 * (uint32_t)(workload_random_next(&seed) % length) + 1;
+            memcpy(&element, &key, sizeof(key));
+            success = dyn_array_insert_sorted(array, &element, compare_elements<Size>) && dyn_array_erase(array, (key + 1) / 2);
+            break;
+        }
+        }
+        if (!success)
+        {
+            state.SkipWithError("insert or erase failed");
+            break;
+        }
+    }
+    report_allocations(state, &phase);
+    state.SetItemsProcessed((int64_t)state.iterations());
+    state.SetComplexityN((int64_t)length);
+    dyn_array_destroy(array);
+}
+
+template <size_t Size>
+static void BM_at(benchmark::State &state, pattern_t pattern)
+{
+    size_t length = (size_t)state.range(0);
+    dyn_array_t *array = make_array<Size>(length);
+    if (array == NULL)
+    {
+        state.SkipWithError("could not create the array");
+        return;
+    }
+    // Shuffled reads defeat the prefetcher, in order reads are the best case
+    std::vector<size_t> order(length);
+    uint64_t seed = 42;
+    for (size_t i = 0; i < length; i++)
+    {
+        order[i] = i;
+        if (pattern == PATTERN_SHUFFLED)
+        {
+            std::swap(order[i], order[workload_random_next(&seed) % (i + 1)]);
+        }
+    }
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            sum += element_key<Size>(dyn_array_at(array, order[i]));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)length);
+    state.SetComplexityN((int64_t)length);
+    dyn_array_destroy(array);
+}
+
+template <size_t Size>
+static void BM_sort(benchmark::State &state, pattern_t pattern)
+{
+    size_t length = (size_t)state.range(0);
+    dyn_array_t *array = make_array<Size>(length);
+    if (array == NULL)
+    {
+        state.SkipWithError("could not create the array");
+        return;
+    }
+    // The unsorted input is kept aside and copied back before every sort, outside the timed region
+    std::vector<element_t<Size>> input(length);
+    uint64_t seed = 42;
+    for (size_t i = 0; i < length; i++)
+    {
+        uint32_t key = pattern == PATTERN_SORTED ? (uint32_t)i : pattern == PATTERN_REVERSED ? (uint32_t)(length - i) : (uint32_t)workload_random_next(&seed);
+        input[i] = make_element<Size>(key);
+    }
+    AllocPhase_t phase;
+    alloc_stats_begin(&phase, "sort");
+    for (auto _ : state)
+    {
+        memcpy(array->array, input.data(), length * Size);
+        auto start = std::chrono::steady_clock::now();
+        bool success = dyn_array_sort(array, compare_elements<Size>);
+        auto end = std::chrono::steady_clock::now();
+        if (!success)
+        {
+            state.SkipWithError("sort failed");
+            break;
+        }
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+    report_allocations(state, &phase);
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)length);
+    state.SetComplexityN((int64_t)length);
+    dyn_array_destroy(array);
+}
+
+// Registers every operation and pattern for one element size
+template <size_t Size>
+static void register_benchmarks()
+{
+    const std::string size = "/element_size:" + std::to_string(Size);
+    const struct
+    {
+        const char *name;
+        pattern_t pattern;
+    } insert_patterns[] = {{"front", PATTERN_FRONT}, {"middle", PATTERN_MIDDLE}, {"back", PATTERN_BACK}, {"sorted", PATTERN_SORTED}};
+    for (const auto &insert : insert_patterns)
+    {
+        benchmark::RegisterBenchmark(("insert_erase/" + std::string(insert.name) + size).c_str(), BM_insert_erase<Size>, insert.pattern)
+            ->RangeMultiplier(10)
+            ->Range(10, 10000000)
+            ->ArgName("length")
+            ->Complexity();
+    }
+    benchmark::RegisterBenchmark(("at/in_order" + size).c_str(), BM_at<Size>, PATTERN_SORTED)
+        ->RangeMultiplier(10)
+        ->Range(10, 10000000)
+        ->ArgName("length")
+        ->Complexity();
+    benchmark::RegisterBenchmark(("at/shuffled" + size).c_str(), BM_at<Size>, PATTERN_SHUFFLED)
+        ->RangeMultiplier(10)
+        ->Range(10, 10000000)
+        ->ArgName("length")
+        ->Complexity();
+    const struct
+    {
+        const char *name;
+        pattern_t pattern;
+    } sort_patterns[] = {{"sorted", PATTERN_SORTED}, {"reversed", PATTERN_REVERSED}, {"random", PATTERN_SHUFFLED}};
+    for (const auto &sort : sort_patterns)
+    {
+        benchmark::RegisterBenchmark(("sort/" + std::string(sort.name) + size).c_str(), BM_sort<Size>, sort.pattern)
+            ->RangeMultiplier(10)
+            ->Range(10, 10000000)
+            ->ArgName("length")
+            ->UseManualTime()
+            ->Unit(benchmark::kMillisecond)
+            ->Complexity();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // CSV unless the command line picks another format, flags given later win
+    std::vector<char *> args;
+    char csv[] = "--benchmark_format=csv";
+    args.push_back(argv[0]);
+    args.push_back(csv);
+    for (int i = 1; i < argc; i++)
+    {
+        args.push_back(argv[i]);
+    }
+    int arg_count = (int)args.size();
+    benchmark::Initialize(&arg_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(arg_count, args.data()))
+    {
+        return 1;
+    }
+    register_benchmarks<4>();
+    register_benchmarks<20>();
+    register_benchmarks<64>();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
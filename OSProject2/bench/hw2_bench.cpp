@@ -0,0 +1,222 @@
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+#include "../include/processing_scheduling.h"
+#include "alloc_stats.h"
+#include "perf_counters.h"
+#include "utilities.h"
+#include "bench_helpers.h"
+
+#include <dyn_array.h>
+
+// Builds a ready queue of 'count' PCBs from a fixed seed. Interarrival times average just over the bursts so the
+// cpu stays busy and the ready queue keeps growing and shrinking, which is the case the schedulers' queues are sized for.
+static dyn_array_t *generate_ready_queue(size_t count)
+{
+    WorkloadSpec_t spec;
+    workload_spec_init(&spec, 0x9E3779B97F4A7C15ULL);
+    return generate_workload_dyn_array(&spec, count);
+}
+
+// The schedulers leave the ready queue as it was, so the last workload is kept for every benchmark of the same size
+// instead of generating 10^7 PCBs again for each one
+static dyn_array_t *workload(benchmark::State &state, size_t count)
+{
+    static dyn_array_t *cached = NULL;
+    if (cached == NULL || dyn_array_size(cached) != count)
+    {
+        dyn_array_destroy(cached);
+        cached = generate_ready_queue(count);
+        if (cached == NULL)
+        {
+            state.SkipWithError("could not generate the workload");
+        }
+    }
+    return cached;
+}
+
+// Reports hardware counters per PCB scheduled under a name prefix, leaving out the ones that aren't available (all of
+// them without perf_event_open permission or a pmu)
+static void report_counters(benchmark::State &state, const char *prefix, const PerfCounterValues_t *values, size_t count)
+{
+    double pcbs = (double)state.iterations() * (double)count;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        if (values->valid[i] && pcbs > 0)
+        {
+            state.counters[std::string(prefix) + perf_counter_name((PerfCounter_t)i) + "/pcb"] = (double)values->values[i] / pcbs;
+        }
+    }
+    if (values->valid[PERF_COUNTER_CYCLES] && values->valid[PERF_COUNTER_INSTRUCTIONS] && values->values[PERF_COUNTER_CYCLES] > 0)
+    {
+        state.counters[std::string(prefix) + "IPC"] = (double)values->values[PERF_COUNTER_INSTRUCTIONS] / (double)values->values[PERF_COUNTER_CYCLES];
+    }
+}
+
+// Hardware counters of the timed loop split into the sort of the keys and the schedule, summed over every iteration
+struct PhaseCounters
+{
+    PerfCounters_t counters;
+    PerfCounterValues_t sort;
+    PerfCounterValues_t schedule;
+};
+
+// Phase callback of the view schedulers, adds each phase of a run to its totals
+static void count_phase(SchedulePhase_t phase, void *arg)
+{
+    PhaseCounters *phase_counters = (PhaseCounters *)arg;
+    PerfCounterValues_t values;
+    switch (phase)
+    {
+    case SCHEDULE_PHASE_SORT:
+        perf_counters_start(&phase_counters->counters);
+        break;
+    case SCHEDULE_PHASE_RUN:
+        perf_counters_stop(&phase_counters->counters, &values);
+        perf_counters_add(&phase_counters->sort, &values);
+        perf_counters_start(&phase_counters->counters);
+        break;
+    case SCHEDULE_PHASE_DONE:
+        perf_counters_stop(&phase_counters->counters, &values);
+        perf_counters_add(&phase_counters->schedule, &values);
+        break;
+    }
+}
+
+// Runs a scheduler over the workload and reports the PCBs scheduled per second, its allocations and the hardware
+// counters per PCB of its sort and its schedule. It goes through the view scheduler with the scratch allocated every
+// run, the same as the dyn_array functions do, so the phase callback can split the counters. Reading the counters
+// costs a few syscalls per run, which shows in the times of the smallest workloads when counters are available.
+static void run_benchmark(benchmark::State &state, const char *algorithm, size_t quantum)
+{
+    size_t count = (size_t)state.range(0);
+    dyn_array_t *ready_queue = workload(state, count);
+    if (ready_queue == NULL)
+    {
+        return;
+    }
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *)dyn_array_export(ready_queue);
+    size_t scratch_size = schedule_scratch_size(count);
+    PhaseCounters phase_counters;
+    bool counting = perf_counters_open(&phase_counters.counters);
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        phase_counters.sort.values[i] = phase_counters.schedule.values[i] = 0;
+        phase_counters.sort.valid[i] = phase_counters.schedule.valid[i] = true; // Until a run finds it unavailable
+    }
+    AllocPhase_t phase;
+    alloc_stats_begin(&phase, "benchmark");
+    for (auto _ : state)
+    {
+        void *scratch = malloc(scratch_size);
+        ScheduleContext_t context;
+        schedule_context_init(&context, scratch, scratch_size);
+        if (counting)
+        {
+            context.phase = count_phase;
+            context.phase_arg = &phase_counters;
+        }
+        ScheduleResult_t result;
+        bool success = scratch != NULL && run_schedule_view(algorithm, pcbs, count, &result, quantum, &context);
+        free(scratch);
+        if (!success)
+        {
+            state.SkipWithError("scheduler failed");
+            break;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+    if (counting)
+    {
+        report_counters(state, "sort-", &phase_counters.sort, count);
+        report_counters(state, "schedule-", &phase_counters.schedule, count);
+    }
+    perf_counters_close(&phase_counters.counters);
+    report_allocations(state, &phase);
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)count);
+    state.SetComplexityN((int64_t)count);
+}
+
+static void BM_first_come_first_serve(benchmark::State &state)
+{
+    run_benchmark(state, "FCFS", 0);
+}
+
+static void BM_shortest_job_first(benchmark::State &state)
+{
+    run_benchmark(state, "SJF", 0);
+}
+
+static void BM_round_robin(benchmark::State &state, size_t quantum)
+{
+    run_benchmark(state, "RR", quantum);
+}
+
+static void BM_shortest_remaining_time_first(benchmark::State &state)
+{
+    run_benchmark(state, "SRTF", 0);
+}
+
+// Round robin through the view scheduler with tracing on, the difference to untraced divided by the events recorded
+// is the per event cost. The ring drains into a no-op callback so the measurement covers recording only.
+static void discard_events(const ScheduleEvent_t *events, size_t count, void *arg)
+{
+    benchmark::DoNotOptimize(events);
+    *(uint64_t *)arg += count;
+}
+
+static void BM_round_robin_traced(benchmark::State &state, bool traced)
+{
+    size_t count = (size_t)state.range(0);
+    dyn_array_t *ready_queue = workload(state, count);
+    if (ready_queue == NULL)
+    {
+        return;
+    }
+    size_t scratch_size = schedule_scratch_size(count);
+    void *scratch = malloc(scratch_size);
+    uint64_t events = 0;
+    ScheduleTrace_t *trace = traced ? schedule_trace_create(1 << 16, discard_events, &events) : NULL;
+    if (scratch == NULL || (traced && trace == NULL))
+    {
+        state.SkipWithError("could not allocate the scratch space or trace");
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            ScheduleContext_t context;
+            schedule_context_init(&context, scratch, scratch_size);
+            context.trace = trace;
+            ScheduleResult_t result;
+            if (!round_robin_view((const ProcessControlBlock_t *)dyn_array_export(ready_queue), count, &result, 10, &context))
+            {
+                state.SkipWithError("scheduler failed");
+                break;
+            }
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    if (trace != NULL)
+    {
+        schedule_trace_flush(trace);
+        state.counters["events"] = benchmark::Counter((double)events, benchmark::Counter::kAvgIterations);
+    }
+    schedule_trace_destroy(trace);
+    free(scratch);
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)count);
+}
+
+BENCHMARK(BM_first_come_first_serve)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK(BM_shortest_job_first)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)->Complexity();
+// Each quantum is its own family so the complexity is fitted per quantum
+BENCHMARK_CAPTURE(BM_round_robin, quantum_1, 1)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK_CAPTURE(BM_round_robin, quantum_10, 10)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK_CAPTURE(BM_round_robin, quantum_100, 100)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK(BM_shortest_remaining_time_first)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK_CAPTURE(BM_round_robin_traced, untraced, false)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_round_robin_traced, traced, true)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,328 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+#include "utilities.h"
+
+// Performance regression runner. Times a fixed matrix of scheduler and dyn_array benchmarks, writes the medians to a
+// JSON baseline and, given an earlier baseline, exits non zero when any benchmark got significantly slower. Build it
+// in Release and run the baseline and the candidate on the same idle machine:
+//
+//   git checkout main && ./hw2_perf_regress --output main.json
+//   git checkout my-branch && ./hw2_perf_regress --baseline main.json
+
+#define DEFAULT_OUTPUT_FILE "perf_results.json"
+#define DEFAULT_REPETITIONS 15
+#define DEFAULT_THRESHOLD 0.05   // Changes of the median under 5% are never reported
+#define DEFAULT_NOISE_FACTOR 3.0 // Nor changes within 3 scaled MADs
+#define WORKLOAD_SEED 0x9E3779B97F4A7C15ULL
+
+// One entry of the matrix, run times the timed part once and stores how long it took
+typedef struct
+{
+    const char *name;
+    size_t size;
+    bool (*run)(size_t size, uint64_t *elapsed_ns);
+} PerfCase_t;
+
+// The schedulers leave the ready queue as it was, so every case of the same size shares one generated workload
+static dyn_array_t *cached_workload = NULL;
+
+static dyn_array_t *workload(size_t size)
+{
+    if (cached_workload == NULL || dyn_array_size(cached_workload) != size)
+    {
+        dyn_array_destroy(cached_workload);
+        WorkloadSpec_t spec;
+        workload_spec_init(&spec, WORKLOAD_SEED);
+        cached_workload = generate_workload_dyn_array(&spec, size);
+    }
+    return cached_workload;
+}
+
+// Private function that times one scheduler run over the shared workload
+static bool run_scheduler(const char *algorithm, size_t quantum, size_t size, uint64_t *elapsed_ns)
+{
+    dyn_array_t *ready_queue = workload(size);
+    if (ready_queue == NULL)
+    {
+        return false;
+    }
+    ScheduleResult_t result;
+    uint64_t start = monotonic_ns();
+    bool success = run_schedule(algorithm, ready_queue, &result, quantum);
+    *elapsed_ns = monotonic_ns() - start;
+    return success;
+}
+
+static bool run_fcfs(size_t size, uint64_t *elapsed_ns)
+{
+    return run_scheduler("FCFS", 0, size, elapsed_ns);
+}
+
+static bool run_sjf(size_t size, uint64_t *elapsed_ns)
+{
+    return run_scheduler("SJF", 0, size, elapsed_ns);
+}
+
+static bool run_rr(size_t size, uint64_t *elapsed_ns)
+{
+    return run_scheduler("RR", 10, size, elapsed_ns);
+}
+
+static bool run_srtf(size_t size, uint64_t *elapsed_ns)
+{
+    return run_scheduler("SRTF", 0, size, elapsed_ns);
+}
+
+static int compare_uint32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Grows an array from empty one push at a time, pays for every reallocation
+static bool run_push_back(size_t size, uint64_t *elapsed_ns)
+{
+    dyn_array_t *array = dyn_array_create(0, sizeof(uint32_t), NULL);
+    if (array == NULL)
+    {
+        return false;
+    }
+    bool success = true;
+    uint64_t start = monotonic_ns();
+    for (uint32_t i = 0; i < size && success; i++)
+    {
+        success = dyn_array_push_back(array, &i);
+    }
+    *elapsed_ns = monotonic_ns() - start;
+    dyn_array_destroy(array);
+    return success;
+}
+
+// Builds a sorted array from random keys with insert_sorted, quadratic in the element moves
+static bool run_insert_sorted(size_t size, uint64_t *elapsed_ns)
+{
+    dyn_array_t *array = dyn_array_create(size, sizeof(uint32_t), NULL);
+    if (array == NULL)
+    {
+        return false;
+    }
+    uint64_t seed = 42; // Fixed so every build times the same data
+    bool success = true;
+    uint64_t start = monotonic_ns();
+    for (size_t i = 0; i < size && success; i++)
+    {
+        uint32_t key = (uint32_t)workload_random_next(&seed);
+        success = dyn_array_insert_sorted(array, &key, compare_uint32);
+    }
+    *elapsed_ns = monotonic_ns() - start;
+    dyn_array_destroy(array);
+    return success;
+}
+
+// Empties an array from the front, each erase shifts the rest down
+static bool run_erase_front(size_t size, uint64_t *elapsed_ns)
+{
+    dyn_array_t *array = dyn_array_create(size, sizeof(uint32_t), NULL);
+    if (array == NULL)
+    {
+        return false;
+    }
+    bool success = true;
+    for (uint32_t i = 0; i < size && success; i++)
+    {
+        success = dyn_array_push_back(array, &i);
+    }
+    uint64_t start = monotonic_ns();
+    while (success && dyn_array_size(array) > 0)
+    {
+        success = dyn_array_erase(array, 0);
+    }
+    *elapsed_ns = monotonic_ns() - start;
+    dyn_array_destroy(array);
+    return success;
+}
+
+// Sorts random keys, only the sort is timed
+static bool run_sort(size_t size, uint64_t *elapsed_ns)
+{
+    dyn_array_t *array = dyn_array_create(size, sizeof(uint32_t), NULL);
+    if (array == NULL)
+    {
+        return false;
+    }
+    uint64_t seed = 42;
+    bool success = true;
+    for (size_t i = 0; i < size && success; i++)
+    {
+        uint32_t key = (uint32_t)workload_random_next(&seed);
+        success = dyn_array_push_back(array, &key);
+    }
+    uint64_t start = monotonic_ns();
+    success = success && dyn_array_sort(array, compare_uint32);
+    *elapsed_ns = monotonic_ns() - start;
+    dyn_array_destroy(array);
+    return success;
+}
+
+// The matrix is fixed so baselines from different builds always line up, sizes are picked so each case runs for
+// a few milliseconds
+static const PerfCase_t perf_cases[] = {
+    {"scheduler/FCFS", 100000, run_fcfs},
+    {"scheduler/SJF", 100000, run_sjf},
+    {"scheduler/RR_q10", 100000, run_rr},
+    {"scheduler/SRTF", 100000, run_srtf},
+    {"dyn_array/push_back", 1000000, run_push_back},
+    {"dyn_array/insert_sorted", 10000, run_insert_sorted},
+    {"dyn_array/erase_front", 10000, run_erase_front},
+    {"dyn_array/sort_random", 1000000, run_sort},
+};
+
+static void print_usage(char *program)
+{
+    printf("%s [options]\n", program);
+    printf("Times a fixed benchmark matrix and compares it with a baseline from an earlier run\n");
+    printf("Options:\n");
+    printf("  --output <file>       write the results as a JSON baseline to <file> (default %s)\n", DEFAULT_OUTPUT_FILE);
+    printf("  --baseline <file>     compare with the baseline in <file> and exit non zero if anything got slower\n");
+    printf("  --repetitions <n>     time every benchmark <n> times after one warm up run (default %d)\n", DEFAULT_REPETITIONS);
+    printf("  --threshold <pct>     ignore changes of the median under <pct> percent (default %.0f)\n", DEFAULT_THRESHOLD * 100);
+    printf("  --noise <k>           ignore changes within <k> scaled MADs of the noisier run (default %.0f)\n", DEFAULT_NOISE_FACTOR);
+    printf("  --filter <text>       only run benchmarks whose name contains <text>\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *output_file = DEFAULT_OUTPUT_FILE;
+    const char *baseline_file = NULL;
+    const char *filter = NULL;
+    size_t repetitions = DEFAULT_REPETITIONS;
+    double threshold = DEFAULT_THRESHOLD;
+    double noise_factor = DEFAULT_NOISE_FACTOR;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--output") == 0 && has_value)
+        {
+            output_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && has_value)
+        {
+            baseline_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && has_value)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && has_value && sscanf(argv[i + 1], "%zu", &repetitions) == 1 && repetitions > 0)
+        {
+            i++;
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && has_value && sscanf(argv[i + 1], "%lf", &threshold) == 1 && threshold >= 0)
+        {
+            threshold /= 100;
+            i++;
+        }
+        else if (strcmp(argv[i], "--noise") == 0 && has_value && sscanf(argv[i + 1], "%lf", &noise_factor) == 1 && noise_factor >= 0)
+        {
+            i++;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Read the baseline first so a bad path fails before minutes of benchmarking
+    size_t baseline_count = 0;
+    PerfMeasurement_t *baseline = NULL;
+    if (baseline_file != NULL && (baseline = perf_baseline_read(baseline_file, &baseline_count)) == NULL)
+    {
+        fprintf(stderr, "Error: Could not read a baseline from '%s'.\n", baseline_file);
+        return EXIT_FAILURE;
+    }
+
+    const size_t case_count = sizeof(perf_cases) / sizeof(perf_cases[0]);
+    PerfMeasurement_t measurements[sizeof(perf_cases) / sizeof(perf_cases[0])];
+    size_t measured = 0;
+    uint64_t *samples = malloc(sizeof(uint64_t) * repetitions);
+    bool success = samples != NULL;
+    size_t regressions = 0;
+    if (baseline != NULL)
+    {
+        printf("%-32s %14s %14s %8s  %s\n", "benchmark", "baseline (ms)", "current (ms)", "change", "verdict");
+    }
+    else
+    {
+        printf("%-32s %14s %14s\n", "benchmark", "median (ms)", "mad (ms)");
+    }
+    for (size_t c = 0; c < case_count && success; c++)
+    {
+        const PerfCase_t *perf_case = &perf_cases[c];
+        char name[PERF_NAME_SIZE];
+        snprintf(name, sizeof(name), "%s/%zu", perf_case->name, perf_case->size);
+        if (filter != NULL && strstr(name, filter) == NULL)
+        {
+            continue;
+        }
+        // One untimed run warms the caches and the allocator and generates the workload
+        uint64_t elapsed_ns;
+        success = perf_case->run(perf_case->size, &elapsed_ns);
+        for (size_t r = 0; r < repetitions && success; r++)
+        {
+            success = perf_case->run(perf_case->size, &samples[r]);
+        }
+        if (!success || !perf_summarize(name, samples, repetitions, &measurements[measured]))
+        {
+            fprintf(stderr, "Error: %s failed.\n", name);
+            success = false;
+            break;
+        }
+        const PerfMeasurement_t *current = &measurements[measured++];
+        const PerfMeasurement_t *previous = baseline ? perf_find(baseline, baseline_count, name) : NULL;
+        if (baseline == NULL)
+        {
+            printf("%-32s %14.3f %14.3f\n", name, current->median_ns / 1e6, current->mad_ns / 1e6);
+        }
+        else if (previous == NULL)
+        {
+            printf("%-32s %14s %14.3f %8s  new\n", name, "-", current->median_ns / 1e6, "");
+        }
+        else
+        {
+            PerfVerdict_t verdict = perf_compare(previous, current, threshold, noise_factor);
+            regressions += verdict == PERF_SLOWER;
+            printf("%-32s %14.3f %14.3f %+7.1f%%  %s\n", name, previous->median_ns / 1e6, current->median_ns / 1e6,
+                   (current->median_ns / previous->median_ns - 1) * 100,
+                   verdict == PERF_SLOWER ? "SLOWER" : verdict == PERF_FASTER ? "faster" : "unchanged");
+        }
+    }
+    free(samples);
+    free(baseline);
+    dyn_array_destroy(cached_workload);
+
+    if (!success)
+    {
+        return EXIT_FAILURE;
+    }
+    if (!perf_baseline_write(output_file, measurements, measured))
+    {
+        fprintf(stderr, "Error: Could not write the results to '%s'.\n", output_file);
+        return EXIT_FAILURE;
+    }
+    printf("Wrote %zu results to %s\n", measured, output_file);
+    if (regressions > 0)
+    {
+        printf("%zu benchmark%s got significantly slower.\n", regressions, regressions == 1 ? "" : "s");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
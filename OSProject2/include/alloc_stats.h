@@ -0,0 +1,57 @@
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+    // Heap accounting. Linking the alloc_stats library replaces malloc, calloc, realloc, free and the aligned
+    // allocators of the whole program (glibc only) with wrappers that count every call before handing it to glibc, so
+    // it also sees the allocations made inside libc, like qsort's temporary buffer. Sizes are the usable sizes glibc
+    // reports, which can be a little more than what was asked for.
+
+    // Allocation counters, either process wide or over one phase
+    typedef struct
+    {
+        uint64_t allocations;     // Calls that handed out a new block (malloc, calloc, aligned allocations, realloc of NULL)
+        uint64_t reallocations;   // realloc calls that resized an existing block
+        uint64_t frees;           // Blocks given back, by free or realloc to 0
+        uint64_t bytes_allocated; // Bytes handed out, a resized block counts its new size
+        int64_t live_bytes;       // Bytes allocated and not freed yet, over a phase what it left allocated
+        int64_t peak_bytes;       // Highest live_bytes seen, over a phase how far it went above what was live before it
+    } AllocStats_t;
+
+    // One phase of a program, e.g. loading or scheduling. Phases can't nest, starting one resets the peak tracking.
+    typedef struct
+    {
+        const char *name;   // Printed by alloc_stats_print
+        AllocStats_t start; // The process wide counters when the phase started
+        AllocStats_t delta; // What the phase did, filled in by alloc_stats_end
+    } AllocPhase_t;
+
+    // Reads the process wide counters
+    // \param stats where the counters are stored
+    void alloc_stats_get(AllocStats_t *stats);
+
+    // Starts a phase
+    // \param phase the phase to start
+    // \param name what the phase is called, has to outlive the phase
+    void alloc_stats_begin(AllocPhase_t *phase, const char *name);
+
+    // Ends a phase and works out what it did
+    // \param phase the phase started with alloc_stats_begin
+    void alloc_stats_end(AllocPhase_t *phase);
+
+    // Prints a finished phase on one line
+    // \param phase the phase to print
+    // \param fp where to print it
+    void alloc_stats_print(const AllocPhase_t *phase, FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
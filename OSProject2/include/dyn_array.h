@@ -12,6 +12,18 @@ extern "C"
 #include <string.h>
 #include <stdint.h>
 
+  // Operation counters, only kept when the library is built with DYN_ARRAY_STATS defined (cmake -DDYN_ARRAY_STATS=ON).
+  // Every translation unit has to agree on the define since it changes the size of struct dyn_array.
+  typedef struct
+  {
+    uint64_t bytes_moved;   // Bytes shifted by memmove to open or close a gap for an insert or remove
+    uint64_t bytes_copied;  // Bytes copied in by inserts and out by extracts
+    uint64_t reallocs;      // Times the storage had to grow
+    uint64_t realloc_bytes; // Bytes asked for by those reallocations
+    uint64_t comparisons;   // Comparator calls made by sort, is_sorted and insert_sorted
+    size_t max_capacity;    // Largest capacity reached, in elements
+  } dyn_array_stats_t;
+
   // This struct defintion was not initially defined in this file
   // I moved it to this file because I was getting there error: "pointer to incomplete class type "struct dyn_array" is not allowedC/C++(393)" when trying to access properties on a 'dyn_array_t' variable
   struct dyn_array
@@ -22,6 +34,9 @@ extern "C"
     const size_t data_size;
     void *array;
     void (*destructor)(void *);
+#ifdef DYN_ARRAY_STATS
+    dyn_array_stats_t stats;
+#endif
   };
 
   typedef struct dyn_array dyn_array_t;
@@ -237,6 +252,15 @@ extern "C"
   ///
   bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *));
 
+  ///
+  /// Checks whether the array is already in the order the comparator describes
+  /// Lets callers skip a sort on data that was handed to them pre-sorted
+  /// \param dyn_array the dynamic array
+  /// \param compare the comparison function
+  /// \return true if no element compares greater than the one after it (false on error)
+  ///
+  bool dyn_array_is_sorted(const dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *));
+
   ///
   /// Inserts the given object into the correct sorted position
   ///  increasing the container size by one
@@ -259,6 +283,26 @@ extern "C"
   ///
   bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *const, void *), void *arg);
 
+  ///
+  /// Reads the operation counters of one array
+  /// \param dyn_array the dynamic array
+  /// \param stats filled with the array's counters since it was created
+  /// \return true if the counters are compiled in, false otherwise (stats is zeroed)
+  ///
+  bool dyn_array_get_stats(const dyn_array_t *const dyn_array, dyn_array_stats_t *const stats);
+
+  ///
+  /// Reads the operation counters summed over every array, safe to call while other threads use their arrays
+  /// \param stats filled with the counters since the program started or the last reset (max_capacity is the largest of any array)
+  /// \return true if the counters are compiled in, false otherwise (stats is zeroed)
+  ///
+  bool dyn_array_get_global_stats(dyn_array_stats_t *const stats);
+
+  ///
+  /// Zeroes the global operation counters, the per array ones are left alone
+  ///
+  void dyn_array_reset_global_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,55 @@
+#ifndef PCB_INDEX_H
+#define PCB_INDEX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+    // Orderings stored in the sidecar index, each matches one of the comparators the schedulers sort with
+    typedef enum
+    {
+        PCB_ORDER_ARRIVAL = 0,       // compare_arrival (first come first serve, round robin)
+        PCB_ORDER_ARRIVAL_BURST = 1, // compare_arrival_burst (shortest job first, shortest remaining time first)
+        PCB_ORDER_COUNT = 2
+    } PcbOrder_t;
+
+    // Builds the path of the sidecar index for a pcb file ("<input_file>.idx")
+    // \param input_file the binary pcb file
+    // \return a malloc'd path the caller frees, NULL for an error
+    char *pcb_index_path(const char *input_file);
+
+    // Computes the content hash the sidecar index is keyed by, an FNV-1a hash over every field of every pcb
+    // \param pcbs the pcbs in file order
+    // \param count the number of pcbs
+    // \return the hash
+    uint64_t pcb_content_hash(const ProcessControlBlock_t *pcbs, size_t count);
+
+    // Adds pcbs to a content hash that is built up a part at a time, starting from FNV_OFFSET_BASIS. Finishing it with
+    // (hash ^ count) * FNV_PRIME over the total count gives the same hash as pcb_content_hash.
+    // \param hash the hash of the pcbs before these
+    // \param pcbs the next pcbs in file order
+    // \param count the number of pcbs
+    // \return the hash including these pcbs
+    uint64_t pcb_content_hash_update(uint64_t hash, const ProcessControlBlock_t *pcbs, size_t count);
+
+    // Loads a binary pcb file and returns its pcbs already in the requested order, using the permutation stored in
+    // the sidecar index instead of sorting. A missing or stale index (content hash mismatch) is rebuilt and rewritten.
+    // The schedulers skip their sort when handed an array that is already in order.
+    // \param input_file the file containing the PCB burst times
+    // \param order the ordering to return the pcbs in
+    // \param index_rebuilt set to whether the sidecar had to be (re)built, may be NULL
+    // \param content_hash set to pcb_content_hash of the pcbs in file order, may be NULL
+    // \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
+    dyn_array_t *load_process_control_blocks_indexed(const char *input_file, PcbOrder_t order, bool *index_rebuilt, uint64_t *content_hash);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
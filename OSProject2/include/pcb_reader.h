@@ -0,0 +1,78 @@
+#ifndef PCB_READER_H
+#define PCB_READER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+    typedef struct pcb_reader pcb_reader_t;
+
+    typedef struct
+    {
+        uint64_t stall_ns;   // Time the consumer spent waiting for the background thread to fill a buffer
+        uint64_t io_ns;      // Time the background thread spent inside read()
+        uint64_t buffers;    // Number of buffers handed from the background thread to the consumer
+        uint64_t bytes_read; // Number of record bytes read from the file
+    } PcbReaderStats_t;
+
+    // Opens a binary pcb file and starts a background thread that reads ahead into one of two buffers
+    // while the caller consumes the other one.
+    // \param input_file the file containing the PCB burst times
+    // \param buffer_records the number of records held by each buffer (0 for a default of 64Ki records)
+    // \return a reader positioned at the first record if function ran successful else NULL for an error
+    pcb_reader_t *pcb_reader_open(const char *input_file, size_t buffer_records);
+
+    // Returns the pcb count from the header of the file
+    // \param reader the reader
+    // \return the number of pcbs the file says it holds
+    uint64_t pcb_reader_count(const pcb_reader_t *reader);
+
+    // Decodes up to max_count of the next records into pcbs, waiting for the background thread if it hasn't filled the next buffer yet
+    // \param reader the reader
+    // \param pcbs destination for the decoded pcbs
+    // \param max_count the maximum number of pcbs to decode
+    // \return the number of pcbs decoded, 0 once every record has been read or an error occurred (see pcb_reader_failed)
+    size_t pcb_reader_read(pcb_reader_t *reader, ProcessControlBlock_t *pcbs, size_t max_count);
+
+    // Reports whether the file turned out to be shorter than its count or couldn't be read
+    // \param reader the reader
+    // \return true if the reader stopped because of an error
+    bool pcb_reader_failed(pcb_reader_t *reader);
+
+    // Stops the background thread and frees the reader
+    // \param reader the reader
+    // \param stats where the reader's stall and I/O timings are copied to, may be NULL
+    void pcb_reader_close(pcb_reader_t *reader, PcbReaderStats_t *stats);
+
+    // Reads the same binary file as load_process_control_blocks through a pcb_reader_t so decoding overlaps with reading
+    // \param input_file the file containing the PCB burst times
+    // \param stats where the reader's stall and I/O timings are copied to, zeroed if the file can't be opened, may be NULL
+    // \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
+    dyn_array_t *load_process_control_blocks_prefetch(const char *input_file, PcbReaderStats_t *stats);
+
+    // Runs First Come First Served over a binary pcb file a chunk at a time as the background thread reads it, so
+    // scheduling overlaps with the I/O and the pcbs are never held in memory all at once. This only works for a file
+    // that is already in arrival order, which makes the schedule its file order; anything else stops at the first pcb
+    // that arrives before the one ahead of it.
+    // \param input_file the file containing the PCB burst times
+    // \param result used for first come first served stat tracking \ref ScheduleResult_t
+    // \param process_count set to the number of pcbs scheduled
+    // \param content_hash set to pcb_content_hash of the pcbs, may be NULL
+    // \param unsorted set to whether the file turned out not to be in arrival order, may be NULL
+    // \param stats where the reader's stall and I/O timings are copied to, zeroed if the file can't be opened, may be NULL
+    // \return true if function ran successful else false for an error or an unsorted file
+    bool first_come_first_serve_prefetch(const char *input_file, ScheduleResult_t *result, size_t *process_count, uint64_t *content_hash,
+                                         bool *unsorted, PcbReaderStats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
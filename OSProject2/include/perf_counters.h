@@ -0,0 +1,79 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+    // Hardware performance counters read through Linux perf_event_open, counting the calling thread and any threads it
+    // starts afterwards, in user space only. Each counter is opened on its own so the ones the cpu or the environment
+    // doesn't support are just left out, and without permission (see /proc/sys/kernel/perf_event_paranoid) or on a
+    // virtual machine without a PMU none are and everything reads as unavailable.
+
+    // The counters collected
+    typedef enum
+    {
+        PERF_COUNTER_CYCLES = 0,
+        PERF_COUNTER_INSTRUCTIONS = 1,
+        PERF_COUNTER_L1D_MISSES = 2, // L1 data cache read misses
+        PERF_COUNTER_LLC_MISSES = 3, // Last level cache misses
+        PERF_COUNTER_BRANCH_MISSES = 4,
+        PERF_COUNTER_COUNT = 5,
+    } PerfCounter_t;
+
+    // The open counters, -1 for the ones that couldn't be opened
+    typedef struct
+    {
+        int fds[PERF_COUNTER_COUNT];
+    } PerfCounters_t;
+
+    // Counts over one stretch of work, scaled up if the kernel had to multiplex the counters
+    typedef struct
+    {
+        uint64_t values[PERF_COUNTER_COUNT];
+        bool valid[PERF_COUNTER_COUNT]; // False for counters that are unavailable
+    } PerfCounterValues_t;
+
+    // Opens every counter that is available, stopped
+    // \param counters the counters to open
+    // \return true if at least one counter could be opened, else false (counters is still safe to use and close)
+    bool perf_counters_open(PerfCounters_t *counters);
+
+    // Closes the counters
+    // \param counters the counters to close
+    void perf_counters_close(PerfCounters_t *counters);
+
+    // Zeroes the counters and starts counting
+    // \param counters the open counters
+    void perf_counters_start(PerfCounters_t *counters);
+
+    // Stops counting and reads the counts since perf_counters_start
+    // \param counters the open counters
+    // \param values where the counts are stored
+    void perf_counters_stop(PerfCounters_t *counters, PerfCounterValues_t *values);
+
+    // Adds one set of counts to another, a count stays valid only if it is valid in both
+    // \param total the counts to add to
+    // \param values the counts to add
+    void perf_counters_add(PerfCounterValues_t *total, const PerfCounterValues_t *values);
+
+    // The short name of a counter for column headers
+    // \param counter the counter
+    // \return the name
+    const char *perf_counter_name(PerfCounter_t counter);
+
+    // Prints one line of counts with instructions per cycle, "n/a" for unavailable counters
+    // \param label what the counts are for
+    // \param values the counts to print
+    // \param fp where to print them
+    void perf_counters_print(const char *label, const PerfCounterValues_t *values, FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
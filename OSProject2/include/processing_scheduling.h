@@ -7,33 +7,136 @@ extern "C"
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "dyn_array.h"
+#include "schedule_timeline.h"
+#include "schedule_trace.h"
 
     typedef struct
     {
-        uint32_t total_burst_time;     // I added this field for waiting time calculation
-        uint32_t remaining_burst_time; // the remaining burst of the pcb
+        uint64_t total_burst_time;     // I added this field for waiting time calculation
+        uint64_t remaining_burst_time; // the remaining burst of the pcb
         uint32_t priority;             // The priority of the task
-        uint32_t arrival;              // Time the process arrived in the ready queue
         bool started;                  // If it has been activated on virtual CPU
         bool completed;                // Denotes whether the pcb has completed its execution
+        uint64_t arrival;              // Time the process arrived in the ready queue
     } ProcessControlBlock_t;           // you may or may not need to add more elements
 
+    // The schedulers add up their totals in 64 bit integers and only divide once at the end, so the averages are exact
+    // to a double's precision however many PCBs there are
     typedef struct
     {
-        float average_waiting_time;    // the average waiting time in the ready queue until first schedule on the cpu
-        float average_turnaround_time; // the average completion time of the PCBs
-        unsigned long total_run_time;  // the total time to process all the PCBs in the ready queue
+        double average_waiting_time;    // the average total time spent waiting in the ready queue (turnaround minus burst)
+        double average_turnaround_time; // the average completion time of the PCBs
+        uint64_t total_run_time;        // the total time to process all the PCBs in the ready queue
+        double average_response_time;   // the average waiting time in the ready queue until first schedule on the cpu
+        uint64_t context_switches;      // the number of times the cpu moved on to a different PCB
+        uint64_t overhead_time;         // the part of total_run_time spent switching between PCBs \ref ScheduleCostModel_t
     } ScheduleResult_t;
 
+    typedef struct
+    {
+        uint64_t first_run;  // Time the pcb first got the cpu
+        uint64_t completion; // Time the pcb finished
+        uint64_t waiting;    // Time spent in the ready queue, turnaround minus burst
+        uint64_t turnaround; // Completion minus arrival
+        uint64_t response;   // First run minus arrival
+    } PcbMetrics_t;
+
+    // What it costs the cpu to switch to a different PCB, charged on every context switch before the PCB runs. The
+    // cold cache penalty grows linearly with how long the PCB has been off the cpu, reaching the full penalty after
+    // cold_cache_window (or straight away if the window is 0). A PCB that has never run is always fully cold.
+    typedef struct
+    {
+        uint32_t switch_cost;        // Fixed time every context switch takes
+        uint32_t cold_cache_penalty; // Extra time to warm the cache back up for a PCB that has been off the cpu
+        uint32_t cold_cache_window;  // Time off the cpu after which the cache is fully cold
+    } ScheduleCostModel_t;
+
+    // Where a view scheduler run has got to, reported to the context's phase callback
+    typedef enum
+    {
+        SCHEDULE_PHASE_SORT = 0, // About to put the PCBs in scheduling order
+        SCHEDULE_PHASE_RUN = 1,  // About to run the scheduling loop
+        SCHEDULE_PHASE_DONE = 2, // The result is written
+    } SchedulePhase_t;
+
+    // Per run state handed to the view schedulers, set it up with schedule_context_init
+    typedef struct
+    {
+        void *scratch;                // Caller owned working memory of at least schedule_scratch_size(count) bytes
+        size_t scratch_size;          // Size of scratch in bytes
+        PcbMetrics_t *metrics;        // Optional, filled with one record per pcb in the order the pcbs were given (NULL to skip)
+        ScheduleTimeline_t *timeline; // Optional, records every stretch a pcb runs for (NULL to skip)
+        ScheduleCostModel_t cost;     // Optional, switching is free when every field is 0
+        ScheduleTrace_t *trace;       // Optional, records arrive, dispatch, preempt and complete events (NULL to skip)
+        void (*phase)(SchedulePhase_t phase, void *arg); // Optional, called as the run enters each phase, e.g. to time or count them (NULL to skip)
+        void *phase_arg;                                 // Passed to phase
+    } ScheduleContext_t;
+
+    // Binary pcb files come in two layouts. The original one is a uint32_t count followed by that many uint32_t burst,
+    // priority, arrival records. The PCB64 layout is for traces whose times or counts don't fit 32 bits, it starts with
+    // PCB64_MAGIC and a uint64_t count followed by uint64_t records in the same order (the priority must still fit a
+    // uint32_t) and nothing after them. Every binary loader reads both.
+#define PCB64_MAGIC "PCB64\0\0"  // 8 bytes counting the terminator
+#define PCB64_MAGIC_SIZE 8
+#define PCB_FILE_HEADER_MAX 16 // Enough of the start of a file to tell the layouts apart
+
+    typedef struct
+    {
+        uint64_t pcb_count; // Number of records the file says it holds
+        size_t header_size; // Bytes before the first record
+        size_t field_size;  // Bytes in each of a record's three fields, 4 or 8
+    } PcbFileLayout_t;
+
+    // Works out which layout a binary pcb file uses from its first bytes and its size. An original layout file whose
+    // count happens to read "PCB6" (about 9.1e8 pcbs) starts with the magic too, so the magic is only trusted when the
+    // size is exactly that of a PCB64 file with the count after it, which an original layout file's size never is.
+    // \param header the start of the file
+    // \param header_size the number of bytes in header, PCB_FILE_HEADER_MAX or fewer if the file is shorter than that
+    // \param file_size the size of the whole file in bytes
+    // \param layout filled in with the file's layout
+    // \return true if function ran successful else false if there isn't even a count
+    bool pcb_file_layout(const void *header, size_t header_size, uint64_t file_size, PcbFileLayout_t *layout);
+
+    // Decodes binary pcb file records into PCBs
+    // \param records the records, 3 * field_size bytes each
+    // \param count the number of records
+    // \param field_size the layout's field size \ref PcbFileLayout_t
+    // \param pcbs where the PCBs are written
+    // \return true if function ran successful else false if a priority doesn't fit 32 bits
+    bool decode_pcb_records(const void *records, size_t count, size_t field_size, ProcessControlBlock_t *pcbs);
+
     // Reads the PCB burst time values from the binary file into ProcessControlBlock_t remaining_burst_time field
     // for N number of PCB burst time stored in the file.
     // \param input_file the file containing the PCB burst times
     // \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
     dyn_array_t *load_process_control_blocks(const char *input_file);
 
+    // Reads the same binary file as load_process_control_blocks, splitting the fixed size records between threads
+    // that each decode their own slice of the destination array. Files that are too small are read on fewer threads.
+    // \param input_file the file containing the PCB burst times
+    // \param thread_count the maximum number of threads to use (0 for one per online cpu)
+    // \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
+    dyn_array_t *load_process_control_blocks_parallel(const char *input_file, size_t thread_count);
+
+    // Reads PCBs from a CSV or TSV text file with one "arrival,burst,priority" record per line.
+    // Blank lines and lines starting with '#' are skipped, and the first line may be a non numeric header.
+    // \param input_file the text file containing the PCB records
+    // \param error_line set to the 1 based line number of the first malformed line (0 if the error isn't tied to a line), may be NULL
+    // \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
+    dyn_array_t *load_process_control_blocks_csv(const char *input_file, size_t *error_line);
+
+    // Converts a CSV or TSV PCB file (see load_process_control_blocks_csv) into the binary format read by load_process_control_blocks,
+    // using the PCB64 layout only if a value doesn't fit the original one
+    // \param input_file the text file containing the PCB records
+    // \param output_file the binary file to create, it is removed again if the conversion fails
+    // \param error_line set to the 1 based line number of the first malformed line (0 if the error isn't tied to a line), may be NULL
+    // \return true if function ran successful else false for an error
+    bool transcode_pcb_csv_to_binary(const char *input_file, const char *output_file, size_t *error_line);
+
     // Runs the First Come First Served Process Scheduling algorithm over the incoming ready_queue
     // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
     // \param result used for first come first served stat tracking \ref ScheduleResult_t
@@ -65,6 +168,71 @@ extern "C"
     // \return true if function ran successful else false for an error
     bool shortest_remaining_time_first(dyn_array_t *ready_queue, ScheduleResult_t *result);
 
+    // The view schedulers below run the same algorithms as the functions above over a read only span of PCBs. They never
+    // modify the PCBs and keep all their working state in the context's scratch memory, so any number of them can run over
+    // one shared trace at the same time as long as each has its own scratch. PCBs are scheduled by their remaining_burst_time.
+
+    // Works out how much scratch memory a view scheduler needs, the scratch must be aligned for a uint64_t
+    // \param count the number of PCBs that will be scheduled
+    // \return the scratch size in bytes, enough for any of the view schedulers
+    size_t schedule_scratch_size(size_t count);
+
+    // Sets up a context with the given scratch memory and every optional feature turned off
+    // \param context the context to initialize
+    // \param scratch caller owned working memory, reused by every run the context is passed to
+    // \param scratch_size size of scratch in bytes
+    void schedule_context_init(ScheduleContext_t *context, void *scratch, size_t scratch_size);
+
+    // Operation counters of the view schedulers, which sort and queue inside their scratch rather than through a
+    // dyn_array. Like dyn_array_stats_t they are only kept in a build with DYN_ARRAY_STATS defined.
+    typedef struct
+    {
+        uint64_t sort_comparisons;  // Comparator calls putting the keys in order, including the check for input already in order
+        uint64_t queue_moves;       // Ready queue entries written by pushes, pops and heap sifts
+        uint64_t queue_bytes_moved; // Bytes those writes moved
+    } ScheduleStats_t;
+
+    // Reads the view scheduler counters summed over every finished run, safe to call while other threads schedule
+    // \param stats filled with the counters since the program started or the last reset
+    // \return true if the counters are compiled in, false otherwise (stats is zeroed)
+    bool schedule_get_global_stats(ScheduleStats_t *stats);
+
+    // Zeroes the view scheduler counters
+    void schedule_reset_global_stats(void);
+
+    // Runs First Come First Served over a read only span of PCBs
+    // \param pcbs the PCBs to schedule, in any order
+    // \param count the number of PCBs
+    // \param result used for first come first served stat tracking \ref ScheduleResult_t
+    // \param context holds the scratch memory \ref ScheduleContext_t
+    // \return true if function ran successful else false for an error
+    bool first_come_first_serve_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, ScheduleContext_t *context);
+
+    // Runs Shortest Job First over a read only span of PCBs
+    // \param pcbs the PCBs to schedule, in any order
+    // \param count the number of PCBs
+    // \param result used for shortest job first stat tracking \ref ScheduleResult_t
+    // \param context holds the scratch memory \ref ScheduleContext_t
+    // \return true if function ran successful else false for an error
+    bool shortest_job_first_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, ScheduleContext_t *context);
+
+    // Runs Round Robin over a read only span of PCBs
+    // \param pcbs the PCBs to schedule, in any order
+    // \param count the number of PCBs
+    // \param result used for round robin stat tracking \ref ScheduleResult_t
+    // \param quantum the quantum
+    // \param context holds the scratch memory \ref ScheduleContext_t
+    // \return true if function ran successful else false for an error
+    bool round_robin_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, size_t quantum, ScheduleContext_t *context);
+
+    // Runs Shortest Remaining Time First over a read only span of PCBs
+    // \param pcbs the PCBs to schedule, in any order
+    // \param count the number of PCBs
+    // \param result used for shortest remaining time first stat tracking \ref ScheduleResult_t
+    // \param context holds the scratch memory \ref ScheduleContext_t
+    // \return true if function ran successful else false for an error
+    bool shortest_remaining_time_first_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, ScheduleContext_t *context);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,60 @@
+#ifndef SCHEDULE_METRICS_H
+#define SCHEDULE_METRICS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "processing_scheduling.h"
+
+    // The per pcb metrics percentiles can be taken over
+    typedef enum
+    {
+        PCB_METRIC_WAITING = 0,
+        PCB_METRIC_TURNAROUND = 1,
+        PCB_METRIC_RESPONSE = 2,
+        PCB_METRIC_COUNT = 3
+    } PcbMetric_t;
+
+    // Tail of one metric over every pcb of a schedule, each percentile is the nearest rank value
+    typedef struct
+    {
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t max;
+    } SchedulePercentiles_t;
+
+    // Reads one metric out of a pcb's metrics
+    // \param metrics the pcb's metrics
+    // \param metric which metric to read
+    // \return the metric's value
+    uint64_t pcb_metric_value(const PcbMetrics_t *metrics, PcbMetric_t metric);
+
+    // Works out the percentiles of one metric by repeated selection over a copy of the values rather than a full sort.
+    // Every selection only partitions what is left above the previous percentile, so the total is linear on average.
+    // \param metrics the per pcb metrics filled in by a view scheduler
+    // \param count the number of pcbs
+    // \param metric which metric to take the percentiles of
+    // \param scratch working memory for 'count' values, NULL to allocate it
+    // \param percentiles where the percentiles are stored
+    // \return true if function ran successful else false for an error
+    bool schedule_percentiles(const PcbMetrics_t *metrics, size_t count, PcbMetric_t metric, uint64_t *scratch, SchedulePercentiles_t *percentiles);
+
+    // Prints a table of the waiting, turnaround and response time percentiles
+    // \param metrics the per pcb metrics filled in by a view scheduler
+    // \param count the number of pcbs
+    // \param file where to print the table
+    // \return true if function ran successful else false for an error
+    bool print_schedule_percentiles(const PcbMetrics_t *metrics, size_t count, FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,76 @@
+#ifndef SCHEDULE_STATE_H
+#define SCHEDULE_STATE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "processing_scheduling.h"
+
+    // A schedule that can be stopped part way, checkpointed and carried on with extra arrivals. It is meant for asking
+    // "what if these pcbs also arrived at t" many times over one base trace: advance the base schedule to t once, then
+    // for every question clone it, append the extra pcbs and finish the clone. Only the part of the schedule from t on
+    // is simulated again and the totals carry on from the checkpoint. The results match running the view schedulers
+    // over the base pcbs followed by the extra ones.
+    typedef struct schedule_state schedule_state_t;
+
+    // Algorithms a schedule state can run
+    typedef enum
+    {
+        SCHEDULE_STATE_FCFS = 0, // First come first served
+        SCHEDULE_STATE_RR = 1,   // Round robin
+    } ScheduleStateAlgorithm_t;
+
+    // Sorts a base trace into a new schedule state positioned at time 0
+    // \param pcbs the base PCBs in any order, scheduled by their remaining_burst_time (may be NULL if count is 0)
+    // \param count the number of PCBs
+    // \param algorithm the algorithm to schedule with
+    // \param quantum the round robin quantum (ignored for first come first served)
+    // \return the state (free with schedule_state_destroy), NULL for an error
+    schedule_state_t *schedule_state_create(const ProcessControlBlock_t *pcbs, size_t count, ScheduleStateAlgorithm_t algorithm, size_t quantum);
+
+    // Checkpoints a schedule state. The base trace is shared rather than copied, so a clone only costs as much as the
+    // pcbs queued at the checkpoint and the ones appended so far. Clones can be used from different threads.
+    // \param state the state to copy
+    // \return the copy (free with schedule_state_destroy), NULL for an error
+    schedule_state_t *schedule_state_clone(const schedule_state_t *state);
+
+    // Frees a schedule state, the base trace goes with the last state sharing it
+    // \param state the state to free, may be NULL
+    void schedule_state_destroy(schedule_state_t *state);
+
+    // Runs every scheduling decision that pcbs arriving at 'time' or later can't change
+    // \param state the state to advance
+    // \param time the earliest arrival that may still be appended
+    // \return true if function ran successful else false for an error (the state can't be used any more)
+    bool schedule_state_advance(schedule_state_t *state, uint64_t time);
+
+    // Adds arrivals to the schedule, they are queued after any pcb of the base trace or an earlier append that
+    // arrives at the same time
+    // \param state the state to add to
+    // \param pcbs the new PCBs, each arriving no earlier than the state has been advanced to
+    // \param count the number of PCBs
+    // \return true if function ran successful else false for an error (nothing is added)
+    bool schedule_state_append(schedule_state_t *state, const ProcessControlBlock_t *pcbs, size_t count);
+
+    // Runs the rest of the schedule and reports it. Pcbs arriving after the last one has finished can still be appended
+    // and the next call to this carries on from there.
+    // \param state the state to finish
+    // \param result the stats of the whole schedule \ref ScheduleResult_t
+    // \return true if function ran successful else false for an error (there are no pcbs)
+    bool schedule_state_finish(schedule_state_t *state, ScheduleResult_t *result);
+
+    // Reports the earliest arrival that can still be appended
+    // \param state the state
+    // \return the time the state has been advanced to
+    uint64_t schedule_state_frontier(const schedule_state_t *state);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,106 @@
+#ifndef SCHEDULE_TIMELINE_H
+#define SCHEDULE_TIMELINE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+    // One stretch of time a pcb spent on a cpu
+    typedef struct
+    {
+        uint32_t pid;   // Index of the pcb in the order the pcbs were given to the scheduler
+        uint32_t cpu;   // The cpu it ran on, the schedulers simulate a single cpu 0
+        uint64_t start; // Time the stretch started
+        uint64_t end;   // Time the stretch ended
+    } ScheduleSegment_t;
+
+    // Execution timeline recorder, a preallocated ring of segments. Back to back segments of the same pcb on the same
+    // cpu are merged into one, and once the ring is full the oldest segments are overwritten so it always holds the
+    // most recent part of the schedule.
+    typedef struct
+    {
+        ScheduleSegment_t *segments; // Ring storage
+        size_t capacity;             // Number of segments the ring holds
+        size_t head;                 // Index of the oldest segment
+        size_t size;                 // Number of segments in the ring
+        uint64_t dropped;            // Segments overwritten after the ring filled up
+    } ScheduleTimeline_t;
+
+    // Allocates a timeline
+    // \param capacity the number of segments to keep
+    // \return the timeline (free with schedule_timeline_destroy), NULL for an error
+    ScheduleTimeline_t *schedule_timeline_create(size_t capacity);
+
+    // Frees a timeline and its segments
+    // \param timeline the timeline to free, may be NULL
+    void schedule_timeline_destroy(ScheduleTimeline_t *timeline);
+
+    // Empties a timeline so it can record another schedule
+    // \param timeline the timeline to clear
+    void schedule_timeline_clear(ScheduleTimeline_t *timeline);
+
+    // Copies out a segment, oldest first
+    // \param timeline the timeline to read
+    // \param index which segment (0 is the oldest still in the ring)
+    // \return the segment, all zero if index is out of range
+    ScheduleSegment_t schedule_timeline_at(const ScheduleTimeline_t *timeline, size_t index);
+
+    // Writes the timeline as Chrome trace event JSON (one complete event per segment, one time unit per microsecond)
+    // that chrome://tracing and the Perfetto UI open offline
+    // \param timeline the timeline to write
+    // \param name the name shown for the schedule, e.g. the algorithm
+    // \param output_file the file to create
+    // \return true if function ran successful else false for an error
+    bool schedule_timeline_write_chrome_trace(const ScheduleTimeline_t *timeline, const char *name, const char *output_file);
+
+    // Copies a string escaping it for use inside a JSON string, shared by every JSON writer
+    // \param str the string to escape
+    // \param dst where the escaped string is written, at least 6 * strlen(str) + 1 chars
+    void json_escape(const char *str, char *dst);
+
+    // Records that a pcb ran from start to end, called by the schedulers
+    // \param timeline the timeline to record into
+    // \param pid index of the pcb
+    // \param cpu the cpu it ran on
+    // \param start time it started running
+    // \param end time it stopped running
+    static inline void schedule_timeline_record(ScheduleTimeline_t *timeline, uint32_t pid, uint32_t cpu, uint64_t start, uint64_t end)
+    {
+        if (timeline->size > 0)
+        {
+            size_t last = timeline->head + timeline->size - 1;
+            ScheduleSegment_t *segment = &timeline->segments[last >= timeline->capacity ? last - timeline->capacity : last];
+            if (segment->pid == pid && segment->cpu == cpu && segment->end == start)
+            {
+                segment->end = end; // It just kept running
+                return;
+            }
+        }
+        size_t tail = timeline->head + timeline->size;
+        ScheduleSegment_t *segment = &timeline->segments[tail >= timeline->capacity ? tail - timeline->capacity : tail];
+        segment->pid = pid;
+        segment->cpu = cpu;
+        segment->start = start;
+        segment->end = end;
+        if (timeline->size < timeline->capacity)
+        {
+            timeline->size++;
+        }
+        else
+        {
+            // Full, the new segment took the oldest one's slot
+            timeline->head = timeline->head + 1 == timeline->capacity ? 0 : timeline->head + 1;
+            timeline->dropped++;
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif
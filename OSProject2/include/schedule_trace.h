@@ -0,0 +1,105 @@
+#ifndef SCHEDULE_TRACE_H
+#define SCHEDULE_TRACE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+    // What happened to a pcb
+    typedef enum
+    {
+        SCHEDULE_EVENT_ARRIVE = 0,   // It arrived, the time is its arrival time
+        SCHEDULE_EVENT_DISPATCH = 1, // It got the cpu, after any switch overhead
+        SCHEDULE_EVENT_PREEMPT = 2,  // It lost the cpu to a different pcb before finishing
+        SCHEDULE_EVENT_COMPLETE = 3, // It finished
+    } ScheduleEventType_t;
+
+    // One fixed size trace event, written to trace files as is (16 bytes in host byte order)
+    typedef struct
+    {
+        uint64_t time; // When it happened
+        uint32_t pid;  // Index of the pcb in the order the pcbs were given to the scheduler
+        uint32_t type; // \ref ScheduleEventType_t
+    } ScheduleEvent_t;
+
+    // Called with the buffered events, oldest first, whenever the ring is dumped
+    typedef void (*ScheduleTraceFlush_t)(const ScheduleEvent_t *events, size_t count, void *arg);
+
+    // Scheduler event trace, a preallocated lock free ring written by one scheduler run at a time. With a flush callback
+    // the ring is dumped through it whenever it fills up and on demand with schedule_trace_flush, so nothing is lost.
+    // Without one the oldest events are overwritten and counted in dropped, and schedule_trace_drain copies events out,
+    // also from another thread while the scheduler is still recording.
+    typedef struct
+    {
+        ScheduleEvent_t *events;    // Ring storage
+        size_t mask;                // Capacity minus one, the capacity is a power of two
+        uint64_t head;              // Events ever recorded, only written by the recording thread
+        uint64_t tail;              // Events ever dumped, drained or dropped
+        uint64_t dropped;           // Events overwritten before anyone read them
+        ScheduleTraceFlush_t flush; // Optional, dumps the ring when it fills up
+        void *flush_arg;            // Passed to flush
+    } ScheduleTrace_t;
+
+    // Allocates a trace
+    // \param capacity the number of events to buffer, rounded up to a power of two
+    // \param flush called with the events whenever the ring fills up or is flushed (NULL to overwrite the oldest instead)
+    // \param flush_arg passed to flush
+    // \return the trace (free with schedule_trace_destroy), NULL for an error
+    ScheduleTrace_t *schedule_trace_create(size_t capacity, ScheduleTraceFlush_t flush, void *flush_arg);
+
+    // Frees a trace and its ring, without flushing it
+    // \param trace the trace to free, may be NULL
+    void schedule_trace_destroy(ScheduleTrace_t *trace);
+
+    // Dumps every buffered event through the flush callback and empties the ring
+    // \param trace the trace to flush
+    // \return true if function ran successful else false for an error (there is no flush callback)
+    bool schedule_trace_flush(ScheduleTrace_t *trace);
+
+    // Copies the oldest buffered events out and removes them from the ring. Lock free, it can run on another thread
+    // while a scheduler records into a trace without a flush callback.
+    // \param trace the trace to read
+    // \param events where the events are copied to
+    // \param max_count the most events to copy
+    // \return the number of events copied
+    size_t schedule_trace_drain(ScheduleTrace_t *trace, ScheduleEvent_t *events, size_t max_count);
+
+    // Flush callback that appends the events to a FILE * passed as the argument in the trace file format
+    // \param events the events to write
+    // \param count the number of events
+    // \param file the FILE * to write to
+    void schedule_trace_write_events(const ScheduleEvent_t *events, size_t count, void *file);
+
+    // Makes room in a full ring, called by schedule_trace_record
+    // \param trace the full trace
+    void schedule_trace_overflow(ScheduleTrace_t *trace);
+
+    // Records an event, called by the schedulers. A handful of stores and one well predicted branch on the ring being full.
+    // \param trace the trace to record into
+    // \param type what happened \ref ScheduleEventType_t
+    // \param pid index of the pcb
+    // \param time when it happened
+    static inline void schedule_trace_record(ScheduleTrace_t *trace, ScheduleEventType_t type, uint32_t pid, uint64_t time)
+    {
+        uint64_t head = trace->head;
+        if (head - __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE) > trace->mask)
+        {
+            schedule_trace_overflow(trace);
+        }
+        ScheduleEvent_t *event = &trace->events[head & trace->mask];
+        event->time = time;
+        event->pid = pid;
+        event->type = (uint32_t)type;
+        __atomic_store_n(&trace->head, head + 1, __ATOMIC_RELEASE); // Publishes the event to drains
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif
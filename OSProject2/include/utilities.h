@@ -3,10 +3,15 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "processing_scheduling.h"
 #include "dyn_array.h"
 
+// 64 bit FNV-1a parameters, shared by pcb_content_hash and the hash the streamed FCFS run builds as it reads
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -27,7 +32,7 @@ extern "C"
     * @param ptr Pointer to an existing pcb. If NULL, memory will be allocated for a new pcb.
     * @return Pointer to the created or updated pcb.
     */
-    ProcessControlBlock_t *create_pcb(uint32_t arrival, uint32_t priority, uint32_t remaining_burst_time, bool started, ProcessControlBlock_t *ptr);
+    ProcessControlBlock_t *create_pcb(uint64_t arrival, uint32_t priority, uint64_t remaining_burst_time, bool started, ProcessControlBlock_t *ptr);
 
     /**
     *
@@ -66,11 +71,21 @@ extern "C"
     * @param result Pointer to schedule result containing results to print.
     * @param file Pointer to FILE where the contents of the result are to be printed to. (If NULL prints to stdout).
     */
-    void print_schedule_result(ScheduleResult_t *result, FILE *file);
+    void print_schedule_result(const ScheduleResult_t *result, FILE *file);
     /*End of test helpers*/
 
     /*Start of analysis helpers*/
 
+    typedef struct
+    {
+        const char *algorithm;          // Short name of the algorithm that was run (see canonical_algorithm)
+        size_t quantum;                 // Quantum used by round robin (0 for the other algorithms)
+        const char *input_file;         // Path of the pcb file the run was loaded from
+        uint64_t input_hash;            // Content hash of the loaded pcbs in file order (see pcb_content_hash)
+        size_t process_count;           // Number of pcbs that were scheduled
+        const ScheduleResult_t *result; // Metrics produced by the run
+    } ScheduleRecord_t;
+
     /**
     *
     * Compares two strings to check for equality.
@@ -127,13 +142,291 @@ extern "C"
     */
     bool is_srtf(char *str);
 
+    /**
+    *
+    * Checks the given string to see if it asks for every algorithm to be run.
+    *
+    * @param str Pointer to the string.
+    * @return bool denoting if the string is equal to the all strings.
+    */
+    bool is_all(char *str);
+
     /**
     *
     * Prints the valid strings for each algorithm.
     */
     void print_valid_algorithms();
+
+    /**
+    *
+    * Runs the algorithm with the given short name over the ready queue.
+    *
+    * @param algorithm The short name of the algorithm (see canonical_algorithm).
+    * @param ready_queue Pointer to the dynamic array of pcbs to schedule.
+    * @param result Pointer to the schedule result to fill in.
+    * @param quantum The quantum used by round robin (ignored by the other algorithms).
+    * @return bool denoting if the algorithm ran successfully.
+    */
+    bool run_schedule(const char *algorithm, dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum);
+
+    /**
+    *
+    * Runs the view scheduler of the algorithm with the given short name over a read only span of pcbs.
+    *
+    * @param algorithm The short name of the algorithm (see canonical_algorithm).
+    * @param pcbs Pointer to the pcbs to schedule.
+    * @param count Number of pcbs.
+    * @param result Pointer to the schedule result to fill in.
+    * @param quantum The quantum used by round robin (ignored by the other algorithms).
+    * @param context Pointer to the context holding the scratch memory and optional per pcb metrics.
+    * @return bool denoting if the algorithm ran successfully.
+    */
+    bool run_schedule_view(const char *algorithm, const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, size_t quantum, ScheduleContext_t *context);
+
+    /**
+    *
+    * Reads the monotonic clock.
+    *
+    * @return The current monotonic time in nanoseconds.
+    */
+    uint64_t monotonic_ns();
+
+    /**
+    *
+    * Checks the extension of the given path to see if it is a text (csv or tsv) pcb file.
+    *
+    * @param path Pointer to the file path.
+    * @return bool denoting if the file should be loaded with load_process_control_blocks_csv.
+    */
+    bool is_csv_file(const char *path);
+
+    /**
+    *
+    * Expands a round robin quantum range "start:end[:step]" into every quantum it covers.
+    * The step is added to the quantum ("4" or "+4", 1 if left out) or multiplies it ("x2").
+    *
+    * @param spec Pointer to the range string.
+    * @param count Pointer to where the number of quanta is stored.
+    * @return A malloc'd array of quanta in increasing order (free with free()), NULL if the range is invalid.
+    */
+    size_t *parse_quantum_range(const char *spec, size_t *count);
+
+    /**
+    *
+    * Maps any accepted spelling of an algorithm onto its short name.
+    *
+    * @param str Pointer to the string.
+    * @return The short name ("FCFS", "SJF", "RR" or "SRTF"), NULL if the string isn't a known algorithm.
+    */
+    const char *canonical_algorithm(char *str);
+
+    /**
+    *
+    * Appends the record as a single JSON line to the results file, creating the file if needed.
+    * The line is written with one O_APPEND write so concurrent runs never interleave records.
+    *
+    * @param results_file Pointer to the path of the results file.
+    * @param record Pointer to the record to append.
+    * @return bool denoting if the whole record was written.
+    */
+    bool append_schedule_record(const char *results_file, const ScheduleRecord_t *record);
     /*End of analysis helpers*/
 
+    /*Start of workload generator*/
+
+    // How the generated pcbs' arrival times are spaced
+    typedef enum
+    {
+        WORKLOAD_ARRIVAL_SIMULTANEOUS = 0, // Every pcb arrives at time 0
+        WORKLOAD_ARRIVAL_UNIFORM = 1,      // Gaps drawn uniformly from 0 to twice the mean
+        WORKLOAD_ARRIVAL_POISSON = 2,      // Exponentially distributed gaps, a Poisson arrival process
+        WORKLOAD_ARRIVAL_BATCHED = 3,      // Batches of batch_size pcbs arrive together, Poisson between the batches
+    } WorkloadArrival_t;
+
+    // How the generated pcbs' burst times are drawn, always clamped to [min_burst, max_burst]
+    typedef enum
+    {
+        WORKLOAD_BURST_CONSTANT = 0,    // Every burst is mean_burst
+        WORKLOAD_BURST_UNIFORM = 1,     // Uniform between min_burst and max_burst
+        WORKLOAD_BURST_EXPONENTIAL = 2, // Exponential with mean_burst, many short jobs and a long tail
+        WORKLOAD_BURST_BIMODAL = 3,     // One in long_job_ratio pcbs runs for max_burst, the rest for min_burst
+    } WorkloadBurst_t;
+
+    // How the generated pcbs' priorities are drawn
+    typedef enum
+    {
+        WORKLOAD_PRIORITY_CONSTANT = 0, // Every pcb has priority 0
+        WORKLOAD_PRIORITY_UNIFORM = 1,  // Uniform over priority_levels levels
+        WORKLOAD_PRIORITY_SKEWED = 2,   // Each level is half as likely as the one before, most pcbs get priority 0
+    } WorkloadPriority_t;
+
+    // The order the pcbs are written out in
+    typedef enum
+    {
+        WORKLOAD_ORDER_ARRIVAL = 0,  // Sorted by arrival time
+        WORKLOAD_ORDER_REVERSED = 1, // Latest arrival first, the worst case for anything that sorts by insertion
+        WORKLOAD_ORDER_SHUFFLED = 2, // A random permutation
+    } WorkloadOrder_t;
+
+    // Describes a workload, the same spec and seed always generate the same pcbs. The adversarial cases are
+    // WORKLOAD_ARRIVAL_SIMULTANEOUS, WORKLOAD_BURST_CONSTANT and WORKLOAD_ORDER_REVERSED, alone or together.
+    typedef struct
+    {
+        uint64_t seed;
+        WorkloadArrival_t arrival;
+        uint64_t mean_interarrival; // Mean gap between arrivals (between batches it is batch_size times this)
+        uint32_t batch_size;        // Pcbs per batch for WORKLOAD_ARRIVAL_BATCHED
+        WorkloadBurst_t burst;
+        uint64_t min_burst;
+        uint64_t max_burst;
+        uint64_t mean_burst;
+        uint32_t long_job_ratio; // One in this many pcbs is a long job for WORKLOAD_BURST_BIMODAL
+        WorkloadPriority_t priority;
+        uint32_t priority_levels;
+        WorkloadOrder_t order;
+    } WorkloadSpec_t;
+
+    // A workload stored one column per field, each array holds at least count values
+    typedef struct
+    {
+        uint64_t *arrivals;
+        uint64_t *bursts;
+        uint32_t *priorities;
+    } WorkloadColumns_t;
+
+    /**
+    *
+    * Fills in a spec for a busy but stable workload: Poisson arrivals every 10 time units on average,
+    * exponential bursts averaging 9 (1 to 1000), uniform priorities over 8 levels, sorted by arrival.
+    *
+    * @param spec Pointer to the spec to fill in.
+    * @param seed The seed the workload is generated from.
+    */
+    void workload_spec_init(WorkloadSpec_t *spec, uint64_t seed);
+
+    /**
+    *
+    * Generates a workload into caller owned pcbs.
+    *
+    * @param spec Pointer to the workload description.
+    * @param pcbs Pointer to where the pcbs are written.
+    * @param count Number of pcbs to generate.
+    * @return bool denoting if the spec was valid (min_burst <= max_burst, a non zero batch size, ratio and level count where they are used).
+    */
+    bool generate_workload(const WorkloadSpec_t *spec, ProcessControlBlock_t *pcbs, size_t count);
+
+    /**
+    *
+    * Generates a workload straight into a new dynamic array.
+    *
+    * @param spec Pointer to the workload description.
+    * @param count Number of pcbs to generate.
+    * @return Pointer to the dynamic array of pcbs, NULL if the spec is invalid or memory allocation fails.
+    */
+    dyn_array_t *generate_workload_dyn_array(const WorkloadSpec_t *spec, size_t count);
+
+    /**
+    *
+    * Generates the same workload as generate_workload into caller owned columns.
+    *
+    * @param spec Pointer to the workload description.
+    * @param columns Pointer to the columns the values are written to.
+    * @param count Number of pcbs to generate.
+    * @return bool denoting if the spec was valid.
+    */
+    bool generate_workload_columns(const WorkloadSpec_t *spec, WorkloadColumns_t *columns, size_t count);
+
+    /**
+    *
+    * Steps the generator the workloads are drawn from (splitmix64), for anything else that needs repeatable random data.
+    *
+    * @param state Pointer to the generator state, a seed to start with and advanced by every call.
+    * @return The next random value.
+    */
+    uint64_t workload_random_next(uint64_t *state);
+    /*End of workload generator*/
+
+    /*Start of perf baselines*/
+
+#define PERF_NAME_SIZE 64 // Longest benchmark name kept in a baseline, including the terminator
+
+    // The timings of one benchmark summarized over its repetitions
+    typedef struct
+    {
+        char name[PERF_NAME_SIZE];
+        size_t repetitions;
+        double median_ns;
+        double mad_ns; // Median absolute deviation from the median, a spread measure that ignores the odd outlier
+        double min_ns;
+    } PerfMeasurement_t;
+
+    // How a benchmark compares to its baseline
+    typedef enum
+    {
+        PERF_UNCHANGED = 0, // Within the threshold or the noise
+        PERF_FASTER = 1,
+        PERF_SLOWER = 2,
+    } PerfVerdict_t;
+
+    /**
+    *
+    * Summarizes the timings of one benchmark.
+    *
+    * @param name Pointer to the benchmark name, truncated to PERF_NAME_SIZE - 1 characters.
+    * @param samples Pointer to the timings in nanoseconds, sorted in place.
+    * @param count Number of timings.
+    * @param measurement Pointer to where the summary is stored.
+    * @return bool denoting if there was at least one timing.
+    */
+    bool perf_summarize(const char *name, uint64_t *samples, size_t count, PerfMeasurement_t *measurement);
+
+    /**
+    *
+    * Compares a measurement with its baseline. The medians have to differ by more than the threshold and by more than
+    * noise_factor scaled MADs (of the noisier of the two) before it counts as a change, so a noisy benchmark needs a
+    * bigger difference than a steady one.
+    *
+    * @param baseline Pointer to the earlier measurement.
+    * @param current Pointer to the new measurement.
+    * @param threshold Smallest relative change of the median that counts (0.05 for 5%).
+    * @param noise_factor How many scaled MADs the medians have to be apart.
+    * @return The verdict.
+    */
+    PerfVerdict_t perf_compare(const PerfMeasurement_t *baseline, const PerfMeasurement_t *current, double threshold, double noise_factor);
+
+    /**
+    *
+    * Writes measurements to a JSON baseline file, replacing the file.
+    *
+    * @param path Pointer to the path of the baseline file.
+    * @param measurements Pointer to the measurements.
+    * @param count Number of measurements.
+    * @return bool denoting if the whole file was written.
+    */
+    bool perf_baseline_write(const char *path, const PerfMeasurement_t *measurements, size_t count);
+
+    /**
+    *
+    * Reads the measurements back from a baseline file written by perf_baseline_write.
+    *
+    * @param path Pointer to the path of the baseline file.
+    * @param count Pointer to where the number of measurements is stored.
+    * @return A malloc'd array of measurements (free with free()), NULL if the file can't be read or holds none.
+    */
+    PerfMeasurement_t *perf_baseline_read(const char *path, size_t *count);
+
+    /**
+    *
+    * Finds a benchmark by name.
+    *
+    * @param measurements Pointer to the measurements to search.
+    * @param count Number of measurements.
+    * @param name Pointer to the benchmark name.
+    * @return Pointer to the measurement, NULL if there is none with that name.
+    */
+    const PerfMeasurement_t *perf_find(const PerfMeasurement_t *measurements, size_t count, const char *name);
+    /*End of perf baselines*/
+
     /*Start of process_scheduling helpers*/
 
     /**
@@ -147,7 +440,7 @@ extern "C"
     * @param current_wait_time Pointer to the variable holding the current wait time.
     * @param cmp_fn Pointer to the comparison function used for sorting processes based on some criteria.
     */
-    void enqueue_processes(dyn_array_t *ready_queue, dyn_array_t *current_processes, uint32_t *current_wait_time, int (*cmp_fn)(const void *, const void *));
+    void enqueue_processes(dyn_array_t *ready_queue, dyn_array_t *current_processes, uint64_t *current_wait_time, int (*cmp_fn)(const void *, const void *));
 
     /**
     *
@@ -189,15 +482,16 @@ extern "C"
     * @param total_run_time Total run time of the algorithm.
     * @param process_count Number of processes in the schedule.
     */
-    void write_schedule_result(ScheduleResult_t *sr, uint32_t total_turnaround_time, uint32_t total_wait_time, uint32_t total_run_time, uint32_t process_count);
+    void write_schedule_result(ScheduleResult_t *sr, uint64_t total_turnaround_time, uint64_t total_wait_time, uint64_t total_run_time, size_t process_count);
 
     /**
     * 
     * Returns a FILE to the readme file (NULL if error).
     * 
+    * @param readme_path Path of the readme to open for reading and writing.
     * @return Pointer to a FILE of the readme (NULL if error).
     */
-    FILE *get_readme();
+    FILE *get_readme(const char *readme_path);
 
     /**
     * 
@@ -210,12 +504,15 @@ extern "C"
 
     /**
     * 
-    * Prints the result to the readme.
+    * Replaces the three line result block starting at line_number in the readme with the result's waiting time,
+    * turnaround time and run time. The rest of the readme is kept as it was.
     * 
+    * @param readme_path Path of the readme to print into.
     * @param result Pointer to the schedule result to print.
     * @param line_number The line number to print the result on.
+    * @return true if the readme was rewritten, false if it couldn't be read or written.
     */
-    bool print_to_readme(ScheduleResult_t *result, int line_number);
+    bool print_to_readme(const char *readme_path, const ScheduleResult_t *result, int line_number);
     /*End of process_scheduling helpers*/
 
 #ifdef __cplusplus
@@ -0,0 +1,164 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "alloc_stats.h"
+
+// glibc's own allocator entry points, the wrappers below hand every call on to these
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+// The counters are zero before main runs and only use atomics, so they work for the allocations libc makes during
+// startup and from any thread
+static struct
+{
+    atomic_uint_fast64_t allocations;
+    atomic_uint_fast64_t reallocations;
+    atomic_uint_fast64_t frees;
+    atomic_uint_fast64_t bytes_allocated;
+    atomic_int_fast64_t live_bytes;
+    atomic_int_fast64_t peak_bytes;       // Never reset
+    atomic_int_fast64_t phase_peak_bytes; // Reset to live_bytes when a phase starts
+} alloc_counters;
+
+// Private function that raises a peak to at least live
+static inline void raise_peak(atomic_int_fast64_t *peak, int_fast64_t live)
+{
+    int_fast64_t seen = atomic_load_explicit(peak, memory_order_relaxed);
+    while (live > seen && !atomic_compare_exchange_weak_explicit(peak, &seen, live, memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+// Private function that counts bytes becoming live (or, when negative, being given back)
+static inline void count_bytes(int_fast64_t bytes)
+{
+    int_fast64_t live = atomic_fetch_add_explicit(&alloc_counters.live_bytes, bytes, memory_order_relaxed) + bytes;
+    if (bytes > 0)
+    {
+        atomic_fetch_add_explicit(&alloc_counters.bytes_allocated, (uint_fast64_t)bytes, memory_order_relaxed);
+        raise_peak(&alloc_counters.peak_bytes, live);
+        raise_peak(&alloc_counters.phase_peak_bytes, live);
+    }
+}
+
+// Private function that counts a new block
+static inline void *count_allocation(void *ptr)
+{
+    if (ptr != NULL)
+    {
+        atomic_fetch_add_explicit(&alloc_counters.allocations, 1, memory_order_relaxed);
+        count_bytes((int_fast64_t)malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+void *malloc(size_t size)
+{
+    return count_allocation(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size)
+{
+    return count_allocation(__libc_calloc(count, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return count_allocation(__libc_memalign(alignment, size));
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    return count_allocation(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    // The alignment has to be a power of two multiple of sizeof(void *)
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    void *block = count_allocation(__libc_memalign(alignment, size));
+    if (block == NULL)
+    {
+        return ENOMEM;
+    }
+    *ptr = block;
+    return 0;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return count_allocation(__libc_realloc(NULL, size));
+    }
+    size_t old_size = malloc_usable_size(ptr);
+    void *block = __libc_realloc(ptr, size);
+    if (block != NULL)
+    {
+        atomic_fetch_add_explicit(&alloc_counters.reallocations, 1, memory_order_relaxed);
+        count_bytes((int_fast64_t)malloc_usable_size(block) - (int_fast64_t)old_size);
+    }
+    else if (size == 0)
+    {
+        // glibc frees the block for a size of 0
+        atomic_fetch_add_explicit(&alloc_counters.frees, 1, memory_order_relaxed);
+        count_bytes(-(int_fast64_t)old_size);
+    }
+    return block;
+}
+
+void free(void *ptr)
+{
+    if (ptr != NULL)
+    {
+        atomic_fetch_add_explicit(&alloc_counters.frees, 1, memory_order_relaxed);
+        count_bytes(-(int_fast64_t)malloc_usable_size(ptr));
+        __libc_free(ptr);
+    }
+}
+
+void alloc_stats_get(AllocStats_t *stats)
+{
+    stats->allocations = atomic_load_explicit(&alloc_counters.allocations, memory_order_relaxed);
+    stats->reallocations = atomic_load_explicit(&alloc_counters.reallocations, memory_order_relaxed);
+    stats->frees = atomic_load_explicit(&alloc_counters.frees, memory_order_relaxed);
+    stats->bytes_allocated = atomic_load_explicit(&alloc_counters.bytes_allocated, memory_order_relaxed);
+    stats->live_bytes = atomic_load_explicit(&alloc_counters.live_bytes, memory_order_relaxed);
+    stats->peak_bytes = atomic_load_explicit(&alloc_counters.peak_bytes, memory_order_relaxed);
+}
+
+void alloc_stats_begin(AllocPhase_t *phase, const char *name)
+{
+    phase->name = name;
+    alloc_stats_get(&phase->start);
+    atomic_store_explicit(&alloc_counters.phase_peak_bytes, phase->start.live_bytes, memory_order_relaxed);
+}
+
+void alloc_stats_end(AllocPhase_t *phase)
+{
+    AllocStats_t now;
+    alloc_stats_get(&now);
+    phase->delta.allocations = now.allocations - phase->start.allocations;
+    phase->delta.reallocations = now.reallocations - phase->start.reallocations;
+    phase->delta.frees = now.frees - phase->start.frees;
+    phase->delta.bytes_allocated = now.bytes_allocated - phase->start.bytes_allocated;
+    phase->delta.live_bytes = now.live_bytes - phase->start.live_bytes;
+    phase->delta.peak_bytes = atomic_load_explicit(&alloc_counters.phase_peak_bytes, memory_order_relaxed) - phase->start.live_bytes;
+}
+
+void alloc_stats_print(const AllocPhase_t *phase, FILE *fp)
+{
+    const AllocStats_t *delta = &phase->delta;
+    fprintf(fp, "Memory %s: peak %" PRId64 " bytes, %" PRIu64 " allocations, %" PRIu64 " reallocations, %" PRIu64 " frees, %" PRIu64
+                " bytes allocated, %" PRId64 " bytes retained\n",
+            phase->name, delta->peak_bytes, delta->allocations, delta->reallocations, delta->frees, delta->bytes_allocated, delta->live_bytes);
+}
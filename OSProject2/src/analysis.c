@@ -1,8 +1,24 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <glob.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include "alloc_stats.h"
 #include "dyn_array.h"
+#include "pcb_index.h"
+#include "pcb_reader.h"
+#include "perf_counters.h"
 #include "processing_scheduling.h"
+#include "schedule_metrics.h"
 #include "utilities.h"
 
 /*Moved to utitiles.c*/
@@ -12,55 +28,867 @@
 // #define SJF "SJF"
 
 #define RESULT_LINE 15
+#define DEFAULT_RESULTS_FILE "results.jsonl"
+#define DEFAULT_README_FILE "../readme.md"
+#define TIMELINE_CAPACITY (1 << 20) // Segments kept by --timeline, older ones are dropped past this
+#define TRACE_CAPACITY (1 << 16)    // Events buffered by --trace between writes to the file
 
-// Add and comment your analysis code in this function.
-// THIS IS NOT FINISHED.
-int main(int argc, char **argv)
+// Prints how the program is meant to be called
+static void print_usage(char *program)
 {
-    if (argc < 3)
+    printf("%s <pcb file> <schedule algorithm | all> [quantum] [options]\n", program);
+    printf("Try passing in ../pcb.bin as the file name\n");
+    printf("Round robin also takes a quantum range 'start:end[:step]' (e.g. 1:256:x2) and reports the best quanta\n");
+    printf("Files ending in .csv or .tsv are read as text with one \'arrival,burst,priority\' record per line\n");
+    printf("Options:\n");
+    printf("  --transcode <file>  write the loaded pcbs to <file> in the binary pcb format\n");
+    printf("  --results <file>    append a JSON record of the run to <file> (default %s)\n", DEFAULT_RESULTS_FILE);
+    printf("  --readme            also render the result into %s\n", DEFAULT_README_FILE);
+    printf("  --percentiles       also print p50/p90/p99/p99.9/max waiting, turnaround and response times\n");
+    printf("  --timeline <file>   write the execution timeline of a single algorithm to <file> as Chrome/Perfetto trace JSON\n");
+    printf("  --trace <file>      write the arrive/dispatch/preempt/complete events of a single algorithm to <file> as 16 byte binary records\n");
+    printf("  --switch-cost <t>   charge <t> time units for every context switch\n");
+    printf("  --cold-cache <p>[:<w>]  also charge up to <p> for a switch to a pcb that has been off the cpu for <w> or more (default 0)\n");
+    printf("  --threads <n>       load binary pcb files with up to <n> threads (0 for one per cpu)\n");
+    printf("  --prefetch          load binary pcb files with a background read-ahead thread and report stall time, FCFS over a file\n");
+    printf("                      already in arrival order is scheduled as it is read instead of after the load\n");
+    printf("  --index             load binary pcb files pre-sorted through the <pcb file>.idx sidecar, rebuilding it if stale\n");
+    printf("  --batch             treat <pcb file> as a directory or glob and schedule every file in it\n");
+    printf("  --jobs <n>          run a quantum range or batch on up to <n> threads (0 for one per cpu, the default)\n");
+    printf("  --stats             print the dyn_array counters of the load and the schedulers' sort and ready queue counters when the\n");
+    printf("                      program exits (needs a -DDYN_ARRAY_STATS=ON build)\n");
+    printf("  --counters          print cycles, instructions, cache and branch misses of the load, sort and schedule of a single algorithm\n");
+    printf("  --timings           print the time and pcbs/sec of the load, sort, schedule and result writing of a single algorithm or all\n");
+    printf("  --memory            print the peak heap use, allocation counts and retained bytes of the load and the schedule, and the totals at exit\n");
+}
+
+// Prints the dyn_array and view scheduler counters summed over the whole run, registered with atexit by --stats so it
+// covers every exit path. The schedulers sort and queue in their own scratch, so the dyn_array counters are mostly the
+// load filling the ready queue.
+static void print_dyn_array_stats(void)
+{
+    dyn_array_stats_t stats;
+    ScheduleStats_t schedule_stats;
+    if (!dyn_array_get_global_stats(&stats) || !schedule_get_global_stats(&schedule_stats))
     {
-        printf("%s <pcb file> <schedule algorithm> [quantum]\n", argv[0]);
-        printf("Try passing in ../pcb.bin as the file name\n");
-        return EXIT_FAILURE;
+        printf("dyn_array stats are compiled out, rebuild with cmake -DDYN_ARRAY_STATS=ON to collect them.\n");
+        return;
+    }
+    printf("dyn_array: %" PRIu64 " bytes moved, %" PRIu64 " bytes copied, %" PRIu64 " reallocs (%" PRIu64 " bytes), %" PRIu64
+           " comparisons, max capacity %zu\n",
+           stats.bytes_moved, stats.bytes_copied, stats.reallocs, stats.realloc_bytes, stats.comparisons, stats.max_capacity);
+    printf("schedulers: %" PRIu64 " sort comparisons, %" PRIu64 " ready queue moves (%" PRIu64 " bytes)\n", schedule_stats.sort_comparisons,
+           schedule_stats.queue_moves, schedule_stats.queue_bytes_moved);
+}
+
+// Prints where a --prefetch load spent its time
+static void print_reader_stats(const PcbReaderStats_t *reader_stats)
+{
+    // A load that mostly waits on the reader thread is I/O bound, otherwise decoding is the bottleneck
+    printf("Load: %.3f ms stalled on I/O, %.3f ms in read() over %llu buffers (%s bound)\n", reader_stats->stall_ns / 1e6,
+           reader_stats->io_ns / 1e6, (unsigned long long)reader_stats->buffers, reader_stats->stall_ns * 2 > reader_stats->io_ns ? "I/O" : "CPU");
+}
+
+// Appends the record of a single algorithm run to the results file and renders it into the readme for --readme
+static void save_schedule_result(const ScheduleRecord_t *record, const char *results_file, bool render_readme)
+{
+    if (!append_schedule_record(results_file, record))
+    {
+        fprintf(stderr, "Error: Could not append the result to \'%s\'.\n", results_file);
+    }
+    if (render_readme)
+    {
+        print_to_readme(DEFAULT_README_FILE, record->result, RESULT_LINE);
+    }
+}
+
+// Prints the heap totals over the whole run and the peak resident set size, registered with atexit by --memory. What is
+// still allocated includes the stdio buffers, which are only freed after this runs.
+static void print_memory_totals(void)
+{
+    AllocStats_t stats;
+    alloc_stats_get(&stats);
+    struct rusage usage;
+    long max_rss = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+    printf("Memory total: peak %" PRId64 " bytes on the heap, %ld KiB resident, %" PRIu64 " allocations, %" PRIu64 " frees, %" PRId64
+           " bytes still allocated at exit\n",
+           stats.peak_bytes, max_rss, stats.allocations, stats.frees, stats.live_bytes);
+}
+
+// Ends a phase of the run, printing what it allocated for --memory
+static void end_memory_phase(AllocPhase_t *phase, bool memory)
+{
+    alloc_stats_end(phase);
+    if (memory)
+    {
+        alloc_stats_print(phase, stdout);
+    }
+}
+
+// What the phases of a run cost. The times are always taken, a few clock reads per run, and printed by --timings; the
+// hardware counters are only read for --counters.
+typedef struct
+{
+    uint64_t load_ns;
+    uint64_t sort_ns;
+    uint64_t schedule_ns;
+    uint64_t write_ns;       // Printing the result and writing the results file, readme, timeline and trace
+    uint64_t phase_start_ns; // When the phase in progress started
+    bool counting;           // The counters below are open
+    PerfCounters_t counters;
+    PerfCounterValues_t load;
+    PerfCounterValues_t sort;
+    PerfCounterValues_t schedule;
+} RunPhases_t;
+
+// Phase callback of the view schedulers, splits the run into the sort and the schedule. The clock is read outside the
+// counter syscalls so they don't end up in the times.
+static void note_schedule_phase(SchedulePhase_t phase, void *arg)
+{
+    RunPhases_t *phases = (RunPhases_t *)arg;
+    uint64_t now = monotonic_ns();
+    switch (phase)
+    {
+    case SCHEDULE_PHASE_SORT:
+        if (phases->counting)
+        {
+            perf_counters_start(&phases->counters);
+        }
+        break;
+    case SCHEDULE_PHASE_RUN:
+        phases->sort_ns = now - phases->phase_start_ns;
+        if (phases->counting)
+        {
+            perf_counters_stop(&phases->counters, &phases->sort);
+            perf_counters_start(&phases->counters);
+        }
+        break;
+    case SCHEDULE_PHASE_DONE:
+        phases->schedule_ns = now - phases->phase_start_ns;
+        if (phases->counting)
+        {
+            perf_counters_stop(&phases->counters, &phases->schedule);
+        }
+        break;
+    }
+    phases->phase_start_ns = monotonic_ns();
+}
+
+// Prints the per phase counters as a table
+static void print_phase_counters(const RunPhases_t *phases)
+{
+    printf("%-10s", "phase");
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        printf(" %14s", perf_counter_name((PerfCounter_t)i));
     }
+    printf(" %6s\n", "IPC");
+    perf_counters_print("load", &phases->load, stdout);
+    perf_counters_print("sort", &phases->sort, stdout);
+    perf_counters_print("schedule", &phases->schedule, stdout);
+}
 
-    char *pcb_file = argv[1];
-    char *algorithm = argv[2];
+// Prints one row of --timings, the throughput is how many pcbs the phase would get through per second
+static void print_phase_time(const char *phase, uint64_t ns, size_t process_count)
+{
+    if (ns > 0)
+    {
+        printf("%-10s %12.3f %16.0f\n", phase, ns / 1e6, process_count * 1e9 / ns);
+    }
+    else
+    {
+        printf("%-10s %12.3f %16s\n", phase, 0.0, "n/a");
+    }
+}
 
-    dyn_array_t *ready_queue = load_process_control_blocks(pcb_file);
-    ScheduleResult_t *sr = malloc(sizeof(ScheduleResult_t));
+// Prints the per phase times and throughput of a run for --timings
+static void print_phase_timings(const char *algorithm, const RunPhases_t *phases, size_t process_count)
+{
+    printf("%-10s %12s %16s\n", algorithm, "Time (ms)", "PCBs/sec");
+    print_phase_time("load", phases->load_ns, process_count);
+    print_phase_time("sort", phases->sort_ns, process_count);
+    print_phase_time("schedule", phases->schedule_ns, process_count);
+    print_phase_time("write", phases->write_ns, process_count);
+    print_phase_time("total", phases->load_ns + phases->sort_ns + phases->schedule_ns + phases->write_ns, process_count);
+}
+
+// Runs one algorithm over the loaded pcbs through its view scheduler with the given switch costs, also filling in the
+// per pcb metrics, the timeline, the event trace and the sort and schedule times and counters when they aren't NULL
+static bool run_view(const char *algorithm, dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum, const ScheduleCostModel_t *cost,
+                     PcbMetrics_t *metrics, ScheduleTimeline_t *timeline, ScheduleTrace_t *trace, RunPhases_t *phases)
+{
+    size_t count = dyn_array_size(ready_queue);
+    size_t scratch_size = schedule_scratch_size(count);
+    void *scratch = malloc(scratch_size);
+    if (scratch == NULL)
+    {
+        return false;
+    }
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    context.metrics = metrics;
+    context.timeline = timeline;
+    context.trace = trace;
+    if (phases != NULL)
+    {
+        context.phase = note_schedule_phase;
+        context.phase_arg = phases;
+    }
+    context.cost = *cost;
+    bool success = run_schedule_view(algorithm, (const ProcessControlBlock_t *)dyn_array_export(ready_queue), count, result, quantum, &context);
+    free(scratch);
+    return success;
+}
 
-    bool algorithm_result = false;
+// One algorithm of an "all" run, the schedulers leave their input untouched so every run shares the loaded pcbs
+typedef struct
+{
+    const char *algorithm;
+    size_t quantum;
+    dyn_array_t *ready_queue;
+    const ScheduleCostModel_t *cost;
+    ScheduleResult_t result;
+    PcbMetrics_t *metrics; // NULL unless percentiles were asked for
+    bool success;
+    uint64_t wall_ns;
+    RunPhases_t phases;
+    pthread_t thread;
+    bool started;
+} algorithm_run_t;
 
-    if (is_fcfs(algorithm))
+// Thread entry point for one algorithm of an "all" run
+static void *run_algorithm_thread(void *arg)
+{
+    algorithm_run_t *run = (algorithm_run_t *)arg;
+    uint64_t start = monotonic_ns();
+    run->success = run_view(run->algorithm, run->ready_queue, &run->result, run->quantum, run->cost, run->metrics, NULL, NULL, &run->phases);
+    run->wall_ns = monotonic_ns() - start;
+    return NULL;
+}
+
+// Runs every algorithm over one loaded queue in parallel and prints them side by side
+static bool run_all_algorithms(dyn_array_t *ready_queue, size_t quantum, const ScheduleCostModel_t *cost, bool percentiles, const char *pcb_file,
+                               uint64_t input_hash, const char *results_file, const RunPhases_t *timings)
+{
+    char *names[] = {"FCFS", "SJF", "RR", "SRTF"};
+    algorithm_run_t runs[4];
+    size_t run_count = 0;
+    size_t process_count = dyn_array_size(ready_queue);
+    bool success = true;
+
+    for (size_t i = 0; i < 4; i++)
     {
-        algorithm_result = first_come_first_serve(ready_queue, sr);
+        if (is_rr(names[i]) && quantum == 0)
+        {
+            continue; // Round robin needs a quantum
+        }
+        algorithm_run_t *run = &runs[run_count++];
+        memset(run, 0, sizeof(algorithm_run_t));
+        run->algorithm = canonical_algorithm(names[i]);
+        run->quantum = is_rr(names[i]) ? quantum : 0;
+        run->ready_queue = ready_queue;
+        run->cost = cost;
+        run->phases.load_ns = timings != NULL ? timings->load_ns : 0;
+        run->metrics = percentiles ? malloc(sizeof(PcbMetrics_t) * process_count) : NULL;
+        run->started = (!percentiles || run->metrics != NULL) && pthread_create(&run->thread, NULL, run_algorithm_thread, run) == 0;
+        success = success && run->started;
     }
-    else if (is_sjf(algorithm))
+
+    printf("%-6s %8s %16s %16s %16s %16s %10s %12s %12s\n", "Algo", "Quantum", "Avg Waiting", "Avg Turnaround", "Avg Response", "Total Run Time",
+           "Switches", "Overhead", "Wall (ms)");
+    for (size_t i = 0; i < run_count; i++)
     {
-        algorithm_result = shortest_job_first(ready_queue, sr);
+        algorithm_run_t *run = &runs[i];
+        if (run->started)
+        {
+            pthread_join(run->thread, NULL);
+        }
+        success = success && run->success;
+        uint64_t write_start = monotonic_ns();
+        if (run->success)
+        {
+            printf("%-6s %8zu %16f %16f %16f %16" PRIu64 " %10" PRIu64 " %12" PRIu64 " %12.3f\n", run->algorithm, run->quantum, run->result.average_waiting_time,
+                   run->result.average_turnaround_time, run->result.average_response_time, run->result.total_run_time,
+                   run->result.context_switches, run->result.overhead_time, run->wall_ns / 1e6);
+            ScheduleRecord_t record = {run->algorithm, run->quantum, pcb_file, input_hash, process_count, &run->result};
+            if (!append_schedule_record(results_file, &record))
+            {
+                fprintf(stderr, "Error: Could not append the result to \'%s\'.\n", results_file);
+            }
+        }
+        else
+        {
+            printf("%-6s %8zu %16s\n", run->algorithm, run->quantum, "error");
+        }
+        run->phases.write_ns = monotonic_ns() - write_start;
     }
-    else if (is_rr(algorithm))
+    for (size_t i = 0; i < run_count; i++)
     {
-        if (argc < 4)
+        if (runs[i].success && runs[i].metrics != NULL)
         {
-            printf("Error: Please provide a quantum as the last parameter for round robin.\n");
-            return EXIT_FAILURE;
+            printf("\n%s\n", runs[i].algorithm);
+            print_schedule_percentiles(runs[i].metrics, process_count, stdout);
         }
-        size_t quantum;
-        int res = sscanf(argv[3], "%zu", &quantum);
-        if (res != 1)
+        free(runs[i].metrics);
+    }
+    for (size_t i = 0; timings != NULL && i < run_count; i++)
+    {
+        // The algorithms run side by side, so on fewer cpus than runs their times overlap
+        if (runs[i].success)
         {
-            printf("Error: Quantum was in an invalid format. Quantum received: %s.\n", argv[3]);
-            return EXIT_FAILURE;
+            printf("\n");
+            print_phase_timings(runs[i].algorithm, &runs[i].phases, process_count);
+        }
+    }
+    return success;
+}
+
+// One quantum of a round robin sweep
+typedef struct
+{
+    size_t quantum;
+    ScheduleResult_t result;
+    bool success;
+    bool pareto_optimal;
+    uint64_t wall_ns;
+} quantum_run_t;
+
+// State shared by the sweep workers, each worker claims the next quantum until none are left
+typedef struct
+{
+    const ProcessControlBlock_t *pcbs; // The loaded pcbs, already sorted by arrival
+    size_t process_count;
+    ScheduleCostModel_t cost;
+    quantum_run_t *runs;
+    size_t run_count;
+    atomic_size_t next_run;
+} quantum_sweep_t;
+
+// Worker thread of a quantum sweep, every quantum it runs reads the shared pcbs and reuses the worker's scratch
+static void *run_quantum_sweep_thread(void *arg)
+{
+    quantum_sweep_t *sweep = (quantum_sweep_t *)arg;
+    size_t scratch_size = schedule_scratch_size(sweep->process_count);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    context.cost = sweep->cost;
+    size_t index;
+    while ((index = atomic_fetch_add(&sweep->next_run, 1)) < sweep->run_count)
+    {
+        quantum_run_t *run = &sweep->runs[index];
+        uint64_t start = monotonic_ns();
+        run->success = round_robin_view(sweep->pcbs, sweep->process_count, &run->result, run->quantum, &context);
+        run->wall_ns = monotonic_ns() - start;
+    }
+    free(scratch);
+    return NULL;
+}
+
+// True if 'a' is no worse than 'b' on every metric and better on at least one
+static bool dominates(const ScheduleResult_t *a, const ScheduleResult_t *b)
+{
+    double metrics_a[] = {a->average_waiting_time, a->average_turnaround_time, a->average_response_time};
+    double metrics_b[] = {b->average_waiting_time, b->average_turnaround_time, b->average_response_time};
+    bool better = false;
+    for (size_t i = 0; i < sizeof(metrics_a) / sizeof(metrics_a[0]); i++)
+    {
+        if (metrics_a[i] > metrics_b[i])
+        {
+            return false;
+        }
+        better = better || metrics_a[i] < metrics_b[i];
+    }
+    return better;
+}
+
+// Runs round robin once per quantum over one loaded queue on a pool of threads, then prints every quantum and the pareto optimal ones
+static bool run_quantum_sweep(dyn_array_t *ready_queue, const size_t *quanta, size_t quantum_count, const ScheduleCostModel_t *cost, size_t jobs,
+                              const char *pcb_file, uint64_t input_hash, const char *results_file)
+{
+    // The pcbs stay in file order, round_robin_view breaks arrival ties on that order so every row matches a single RR run
+    quantum_sweep_t sweep;
+    sweep.pcbs = (const ProcessControlBlock_t *)dyn_array_export(ready_queue);
+    sweep.process_count = dyn_array_size(ready_queue);
+    sweep.cost = *cost;
+    sweep.run_count = quantum_count;
+    sweep.runs = calloc(quantum_count, sizeof(quantum_run_t));
+    atomic_init(&sweep.next_run, 0);
+    if (sweep.runs == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < quantum_count; i++)
+    {
+        sweep.runs[i].quantum = quanta[i];
+    }
+
+    if (jobs == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (jobs > quantum_count)
+    {
+        jobs = quantum_count;
+    }
+    pthread_t *threads = malloc(sizeof(pthread_t) * jobs);
+    size_t started = 0;
+    while (threads != NULL && started < jobs && pthread_create(&threads[started], NULL, run_quantum_sweep_thread, &sweep) == 0)
+    {
+        started++;
+    }
+    if (started == 0)
+    {
+        run_quantum_sweep_thread(&sweep); // No threads to be had, run the sweep on this one
+    }
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    bool success = true;
+    for (size_t i = 0; i < quantum_count; i++)
+    {
+        quantum_run_t *run = &sweep.runs[i];
+        success = success && run->success;
+        run->pareto_optimal = run->success;
+        for (size_t j = 0; run->pareto_optimal && j < quantum_count; j++)
+        {
+            run->pareto_optimal = !(sweep.runs[j].success && dominates(&sweep.runs[j].result, &run->result));
+        }
+    }
+
+    printf("%8s %16s %16s %16s %16s %10s %12s %12s\n", "Quantum", "Avg Waiting", "Avg Turnaround", "Avg Response", "Total Run Time", "Switches",
+           "Overhead", "Wall (ms)");
+    for (size_t i = 0; i < quantum_count; i++)
+    {
+        quantum_run_t *run = &sweep.runs[i];
+        if (!run->success)
+        {
+            printf("%8zu %16s\n", run->quantum, "error");
+            continue;
+        }
+        printf("%8zu %16f %16f %16f %16" PRIu64 " %10" PRIu64 " %12" PRIu64 " %12.3f%s\n", run->quantum, run->result.average_waiting_time,
+               run->result.average_turnaround_time, run->result.average_response_time, run->result.total_run_time, run->result.context_switches,
+               run->result.overhead_time, run->wall_ns / 1e6, run->pareto_optimal ? " *" : "");
+        ScheduleRecord_t record = {"RR", run->quantum, pcb_file, input_hash, sweep.process_count, &run->result};
+        if (!append_schedule_record(results_file, &record))
+        {
+            fprintf(stderr, "Error: Could not append the result to '%s'.\n", results_file);
         }
-        algorithm_result = round_robin(ready_queue, sr, quantum);
     }
-    else if (is_srtf(algorithm))
+    printf("Best quanta (* no other quantum is as good on waiting, turnaround and response time and better on one):");
+    for (size_t i = 0; i < quantum_count; i++)
     {
-        algorithm_result = shortest_remaining_time_first(ready_queue, sr);
+        if (sweep.runs[i].pareto_optimal)
+        {
+            printf(" %zu", sweep.runs[i].quantum);
+        }
+    }
+    printf("\n");
+    free(sweep.runs);
+    return success;
+}
+
+// A batch of pcb files, workers claim the next file until none are left so at most one file per worker is in memory
+typedef struct
+{
+    char **files;
+    size_t file_count;
+    atomic_size_t next_file;
+    char *algorithms[4]; // Short names of the algorithms to run on every file
+    size_t algorithm_count;
+    size_t quantum;
+    ScheduleCostModel_t cost;
+    const char *results_file;
+
+    pthread_mutex_t lock; // Guards stdout and the totals below
+    size_t files_scheduled;
+    size_t files_failed;
+    unsigned long long processes_scheduled;
+} batch_t;
+
+static int compare_strings(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Whether a batch should schedule a listed path, hidden files, pcb indexes and anything that isn't a regular file are skipped
+static bool is_batch_file(const char *path)
+{
+    const char *name = strrchr(path, '/');
+    name = name != NULL ? name + 1 : path;
+    size_t name_length = strlen(name);
+    struct stat info;
+    return name[0] != '.' && (name_length < 4 || strcmp(name + name_length - 4, ".idx") != 0) && stat(path, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+// Lists the pcb files in a directory or that a glob matches (see is_batch_file) in sorted order
+static char **collect_batch_files(const char *spec, size_t *count)
+{
+    char **files = NULL;
+    size_t file_count = 0;
+    struct stat info;
+    if (stat(spec, &info) == 0 && S_ISDIR(info.st_mode))
+    {
+        DIR *dir = opendir(spec);
+        if (dir == NULL)
+        {
+            return NULL;
+        }
+        size_t capacity = 0;
+        size_t spec_length = strlen(spec);
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            size_t name_length = strlen(entry->d_name);
+            char *path = malloc(spec_length + name_length + 2);
+            if (path == NULL)
+            {
+                break;
+            }
+            snprintf(path, spec_length + name_length + 2, "%s/%s", spec, entry->d_name);
+            if (!is_batch_file(path))
+            {
+                free(path);
+                continue;
+            }
+            if (file_count == capacity)
+            {
+                capacity = capacity ? capacity * 2 : 64;
+                char **grown = realloc(files, sizeof(char *) * capacity);
+                if (grown == NULL)
+                {
+                    free(path);
+                    break;
+                }
+                files = grown;
+            }
+            files[file_count++] = path;
+        }
+        closedir(dir);
+        qsort(files, file_count, sizeof(char *), compare_strings);
     }
     else
+    {
+        glob_t matches;
+        if (glob(spec, 0, NULL, &matches) != 0)
+        {
+            return NULL;
+        }
+        files = malloc(sizeof(char *) * matches.gl_pathc);
+        for (size_t i = 0; files != NULL && i < matches.gl_pathc; i++)
+        {
+            if (!is_batch_file(matches.gl_pathv[i]))
+            {
+                continue;
+            }
+            char *path = strdup(matches.gl_pathv[i]);
+            if (path == NULL)
+            {
+                break; // Like the directory listing, the batch goes ahead with the files collected so far
+            }
+            files[file_count++] = path;
+        }
+        globfree(&matches);
+    }
+    *count = file_count;
+    return files;
+}
+
+// Worker thread of a batch, it loads one file at a time and streams a record per algorithm to the results file
+static void *run_batch_thread(void *arg)
+{
+    batch_t *batch = (batch_t *)arg;
+    size_t index;
+    while ((index = atomic_fetch_add(&batch->next_file, 1)) < batch->file_count)
+    {
+        const char *pcb_file = batch->files[index];
+        dyn_array_t *source = is_csv_file(pcb_file) ? load_process_control_blocks_csv(pcb_file, NULL) : load_process_control_blocks(pcb_file);
+        bool success = source != NULL;
+        uint64_t input_hash = success ? pcb_content_hash((const ProcessControlBlock_t *)dyn_array_export(source), dyn_array_size(source)) : 0;
+        size_t process_count = source ? dyn_array_size(source) : 0;
+        ScheduleResult_t results[4];
+        for (size_t i = 0; success && i < batch->algorithm_count; i++)
+        {
+            success = run_view(batch->algorithms[i], source, &results[i], batch->quantum, &batch->cost, NULL, NULL, NULL, NULL);
+        }
+        dyn_array_destroy(source);
+
+        pthread_mutex_lock(&batch->lock);
+        if (!success)
+        {
+            batch->files_failed++;
+            printf("%-40s %s\n", pcb_file, "error");
+        }
+        else
+        {
+            batch->files_scheduled++;
+            batch->processes_scheduled += process_count;
+            for (size_t i = 0; i < batch->algorithm_count; i++)
+            {
+                bool is_round_robin = is_rr(batch->algorithms[i]);
+                printf("%-40s %-6s %8zu %16f %16f %16f %16" PRIu64 " %10" PRIu64 " %12" PRIu64 "\n", pcb_file, batch->algorithms[i], is_round_robin ? batch->quantum : 0,
+                       results[i].average_waiting_time, results[i].average_turnaround_time, results[i].average_response_time,
+                       results[i].total_run_time, results[i].context_switches, results[i].overhead_time);
+                ScheduleRecord_t record = {batch->algorithms[i], is_round_robin ? batch->quantum : 0, pcb_file, input_hash, process_count, &results[i]};
+                if (!append_schedule_record(batch->results_file, &record))
+                {
+                    fprintf(stderr, "Error: Could not append the result to '%s'.\n", batch->results_file);
+                }
+            }
+        }
+        pthread_mutex_unlock(&batch->lock);
+    }
+    return NULL;
+}
+
+// Schedules every file a directory or glob names on a pool of threads, one record per file and algorithm goes to the results file
+static bool run_batch(const char *spec, const char *algorithm_name, size_t quantum, const ScheduleCostModel_t *cost, size_t jobs, const char *results_file)
+{
+    batch_t batch;
+    memset(&batch, 0, sizeof(batch_t));
+    batch.files = collect_batch_files(spec, &batch.file_count);
+    if (batch.files == NULL || batch.file_count == 0)
+    {
+        printf("Error: No pcb files found in '%s'.\n", spec);
+        free(batch.files);
+        return false;
+    }
+    atomic_init(&batch.next_file, 0);
+    char *names[] = {"FCFS", "SJF", "RR", "SRTF"};
+    for (size_t i = 0; i < 4; i++)
+    {
+        // Every algorithm for "all" (round robin only with a quantum), otherwise just the one asked for
+        if (algorithm_name == NULL ? !is_rr(names[i]) || quantum > 0 : strcmp(algorithm_name, names[i]) == 0)
+        {
+            batch.algorithms[batch.algorithm_count++] = names[i];
+        }
+    }
+    batch.quantum = quantum;
+    batch.cost = *cost;
+    batch.results_file = results_file;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    if (jobs == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (jobs > batch.file_count)
+    {
+        jobs = batch.file_count;
+    }
+    printf("%-40s %-6s %8s %16s %16s %16s %16s %10s %12s\n", "File", "Algo", "Quantum", "Avg Waiting", "Avg Turnaround", "Avg Response",
+           "Total Run Time", "Switches", "Overhead");
+    pthread_t *threads = malloc(sizeof(pthread_t) * jobs);
+    size_t started = 0;
+    while (threads != NULL && started < jobs && pthread_create(&threads[started], NULL, run_batch_thread, &batch) == 0)
+    {
+        started++;
+    }
+    if (started == 0)
+    {
+        run_batch_thread(&batch); // No threads to be had, run the batch on this one
+    }
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&batch.lock);
+
+    printf("Scheduled %zu of %zu files (%llu pcbs), %zu failed\n", batch.files_scheduled, batch.file_count,
+           batch.processes_scheduled, batch.files_failed);
+    for (size_t i = 0; i < batch.file_count; i++)
+    {
+        free(batch.files[i]);
+    }
+    free(batch.files);
+    return batch.files_failed == 0;
+}
+
+// Add and comment your analysis code in this function.
+// THIS IS NOT FINISHED.
+int main(int argc, char **argv)
+{
+    char *positional[3] = {NULL, NULL, NULL}; // pcb file, algorithm and quantum
+    int positional_count = 0;
+    char *transcode_file = NULL;
+    char *results_file = DEFAULT_RESULTS_FILE;
+    bool render_readme = false;
+    size_t load_threads = 1;
+    bool prefetch = false;
+    bool use_index = false;
+    size_t jobs = 0;
+    bool batch = false;
+    bool percentiles = false;
+    bool memory = false;
+    bool counters = false;
+    bool timings = false;
+    char *timeline_file = NULL;
+    char *trace_file = NULL;
+    ScheduleCostModel_t cost = {0, 0, 0};
+
+    // Split the options from the positional arguments
+    for (int i = 1; i < argc; i++)
+    {
+        if (str_is_equal(argv[i], "--transcode", 12))
+        {
+            if (i + 1 >= argc)
+            {
+                printf("Error: --transcode requires an output file.\n");
+                return EXIT_FAILURE;
+            }
+            transcode_file = argv[++i];
+        }
+        else if (str_is_equal(argv[i], "--results", 10))
+        {
+            if (i + 1 >= argc)
+            {
+                printf("Error: --results requires an output file.\n");
+                return EXIT_FAILURE;
+            }
+            results_file = argv[++i];
+        }
+        else if (str_is_equal(argv[i], "--threads", 10))
+        {
+            if (i + 1 >= argc || sscanf(argv[i + 1], "%zu", &load_threads) != 1)
+            {
+                printf("Error: --threads requires a thread count.\n");
+                return EXIT_FAILURE;
+            }
+            i++;
+        }
+        else if (str_is_equal(argv[i], "--jobs", 7))
+        {
+            if (i + 1 >= argc || sscanf(argv[i + 1], "%zu", &jobs) != 1)
+            {
+                printf("Error: --jobs requires a thread count.\n");
+                return EXIT_FAILURE;
+            }
+            i++;
+        }
+        else if (str_is_equal(argv[i], "--timeline", 11))
+        {
+            if (i + 1 >= argc)
+            {
+                printf("Error: --timeline requires an output file.\n");
+                return EXIT_FAILURE;
+            }
+            timeline_file = argv[++i];
+        }
+        else if (str_is_equal(argv[i], "--trace", 8))
+        {
+            if (i + 1 >= argc)
+            {
+                printf("Error: --trace requires an output file.\n");
+                return EXIT_FAILURE;
+            }
+            trace_file = argv[++i];
+        }
+        else if (str_is_equal(argv[i], "--switch-cost", 14))
+        {
+            if (i + 1 >= argc || sscanf(argv[i + 1], "%u", &cost.switch_cost) != 1)
+            {
+                printf("Error: --switch-cost requires a time.\n");
+                return EXIT_FAILURE;
+            }
+            i++;
+        }
+        else if (str_is_equal(argv[i], "--cold-cache", 13))
+        {
+            if (i + 1 >= argc || sscanf(argv[i + 1], "%u:%u", &cost.cold_cache_penalty, &cost.cold_cache_window) < 1)
+            {
+                printf("Error: --cold-cache requires a penalty and optionally a window, e.g. 5:100.\n");
+                return EXIT_FAILURE;
+            }
+            i++;
+        }
+        else if (str_is_equal(argv[i], "--percentiles", 14))
+        {
+            percentiles = true;
+        }
+        else if (str_is_equal(argv[i], "--batch", 8))
+        {
+            batch = true;
+        }
+        else if (str_is_equal(argv[i], "--prefetch", 11))
+        {
+            prefetch = true;
+        }
+        else if (str_is_equal(argv[i], "--index", 8))
+        {
+            use_index = true;
+        }
+        else if (str_is_equal(argv[i], "--stats", 8))
+        {
+            atexit(print_dyn_array_stats);
+        }
+        else if (str_is_equal(argv[i], "--counters", 11))
+        {
+            counters = true;
+        }
+        else if (str_is_equal(argv[i], "--timings", 10))
+        {
+            timings = true;
+        }
+        else if (str_is_equal(argv[i], "--memory", 9))
+        {
+            memory = true;
+            atexit(print_memory_totals);
+        }
+        else if (str_is_equal(argv[i], "--readme", 9))
+        {
+            render_readme = true;
+        }
+        else if (positional_count < 3)
+        {
+            positional[positional_count++] = argv[i];
+        }
+        else
+        {
+            printf("Error: Unexpected argument \'%s\'.\n", argv[i]);
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (positional_count < 1 || (positional_count < 2 && transcode_file == NULL))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char *pcb_file = positional[0];
+    char *algorithm = positional[1];
+
+    if (transcode_file != NULL)
+    {
+        // Only text files need converting, binary files are already in the right format
+        size_t error_line = 0;
+        if (!is_csv_file(pcb_file) || !transcode_pcb_csv_to_binary(pcb_file, transcode_file, &error_line))
+        {
+            printf("Error: Could not transcode \'%s\' to \'%s\'", pcb_file, transcode_file);
+            if (error_line != 0)
+            {
+                printf(" (line %zu is invalid)", error_line);
+            }
+            printf(".\n");
+            return EXIT_FAILURE;
+        }
+        if (algorithm == NULL)
+        {
+            return EXIT_SUCCESS; // Nothing to schedule, the conversion was all that was asked for
+        }
+    }
+
+    // Work out what to run before paying for the load
+    bool run_all = is_all(algorithm);
+    const char *algorithm_name = canonical_algorithm(algorithm);
+    if (!run_all && algorithm_name == NULL)
     {
         printf("Error: The schedule algorithm requested \'%s\' was not found.\n", algorithm);
         print_valid_algorithms();
@@ -69,19 +897,300 @@ int main(int argc, char **argv)
     // else if(is_priority(algorithm)){
     //     algorithm_result = priority(ready_queue, sr);
     // }
+    size_t quantum = 0;
+    size_t *quanta = NULL;
+    size_t quantum_count = 0;
+    if (positional_count >= 3 && strchr(positional[2], ':') != NULL)
+    {
+        // A quantum range sweeps round robin instead of running it once
+        quanta = is_rr(algorithm) ? parse_quantum_range(positional[2], &quantum_count) : NULL;
+        if (quanta == NULL)
+        {
+            printf("Error: Quantum range '%s' is invalid, it should look like start:end[:step] and only works with round robin.\n", positional[2]);
+            return EXIT_FAILURE;
+        }
+    }
+    else if (positional_count >= 3)
+    {
+        int res = sscanf(positional[2], "%zu", &quantum);
+        if (res != 1)
+        {
+            printf("Error: Quantum was in an invalid format. Quantum received: %s.\n", positional[2]);
+            return EXIT_FAILURE;
+        }
+    }
+    else if (!run_all && is_rr(algorithm))
+    {
+        printf("Error: Please provide a quantum as the last parameter for round robin.\n");
+        return EXIT_FAILURE;
+    }
 
-    if (algorithm_result)
+    if (timeline_file != NULL && (batch || run_all || quanta != NULL))
     {
-        print_schedule_result(sr, NULL);
-        print_to_readme(sr, RESULT_LINE);
+        printf("Error: --timeline needs a single algorithm and quantum.\n");
+        free(quanta);
+        return EXIT_FAILURE;
     }
-    else
+
+    if (trace_file != NULL && (batch || run_all || quanta != NULL))
     {
-        printf("There was an error running the %s algorithm.\n", algorithm);
+        printf("Error: --trace needs a single algorithm and quantum.\n");
+        free(quanta);
         return EXIT_FAILURE;
     }
+
+    if (counters && (batch || run_all || quanta != NULL))
+    {
+        printf("Error: --counters needs a single algorithm and quantum.\n");
+        free(quanta);
+        return EXIT_FAILURE;
+    }
+
+    if (timings && (batch || quanta != NULL))
+    {
+        printf("Error: --timings needs a single algorithm or all and a single quantum.\n");
+        free(quanta);
+        return EXIT_FAILURE;
+    }
+
+    if (batch)
+    {
+        if (quanta != NULL)
+        {
+            printf("Error: Quantum ranges can't be combined with --batch.\n");
+            free(quanta);
+            return EXIT_FAILURE;
+        }
+        return run_batch(pcb_file, run_all ? NULL : algorithm_name, quantum, &cost, jobs, results_file) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Counting needs perf_event_open permission and a pmu, without them the run carries on uncounted
+    RunPhases_t phases;
+    memset(&phases, 0, sizeof(phases));
+    bool counting = counters && perf_counters_open(&phases.counters);
+    phases.counting = counting;
+    if (counters && !counting)
+    {
+        printf("Hardware counters are unavailable (no pmu, or /proc/sys/kernel/perf_event_paranoid forbids them), running without.\n");
+    }
+    if (counting)
+    {
+        perf_counters_start(&phases.counters);
+    }
+    // Every exit from here on falls through to the cleanup at the end, so --memory only reports what is really retained
+    int status = EXIT_FAILURE;
+    bool finished = false; // Set once the streamed run has succeeded or failed, leaving only the cleanup
+    dyn_array_t *ready_queue = NULL;
+    ScheduleResult_t *sr = NULL;
+    PcbMetrics_t *metrics = NULL;
+    ScheduleTimeline_t *timeline = NULL;
+    FILE *trace_out = NULL;
+    ScheduleTrace_t *trace = NULL;
+    AllocPhase_t phase;
+    // FCFS over a file in arrival order runs as the file is read, without ever holding all of it. Anything else, or a
+    // run that needs the pcbs afterwards, takes the full load below.
+    if (prefetch && !run_all && quanta == NULL && is_fcfs(algorithm) && !is_csv_file(pcb_file) && !use_index && !percentiles && timeline_file == NULL &&
+        trace_file == NULL && !counters && cost.switch_cost == 0 && cost.cold_cache_penalty == 0)
+    {
+        ScheduleResult_t result;
+        size_t process_count = 0;
+        uint64_t input_hash = 0;
+        bool unsorted = false;
+        PcbReaderStats_t reader_stats;
+        uint64_t stream_start = monotonic_ns();
+        alloc_stats_begin(&phase, "load and schedule");
+        bool streamed = first_come_first_serve_prefetch(pcb_file, &result, &process_count, &input_hash, &unsorted, &reader_stats);
+        end_memory_phase(&phase, memory);
+        phases.load_ns = monotonic_ns() - stream_start;
+        if (streamed)
+        {
+            print_reader_stats(&reader_stats);
+            uint64_t write_start = monotonic_ns();
+            print_schedule_result(&result, NULL);
+            ScheduleRecord_t record = {algorithm_name, 0, pcb_file, input_hash, process_count, &result};
+            save_schedule_result(&record, results_file, render_readme);
+            phases.write_ns = monotonic_ns() - write_start;
+            if (timings)
+            {
+                printf("The schedule ran while the pcbs were read, the load includes it\n");
+                print_phase_timings(algorithm_name, &phases, process_count);
+            }
+            status = EXIT_SUCCESS;
+            finished = true;
+        }
+        else if (!unsorted)
+        {
+            printf("Error: Could not load the pcbs from \'%s\'.\n", pcb_file);
+            finished = true;
+        }
+        else
+        {
+            printf("%s isn't in arrival order, loading all of it to sort it\n", pcb_file);
+        }
+    }
+    bool hashed = false; // The indexed load hashes the pcbs before reordering them
+    uint64_t input_hash = 0;
+    if (!finished)
+    {
+        uint64_t load_start = monotonic_ns();
+        alloc_stats_begin(&phase, "load");
+        if (is_csv_file(pcb_file))
+        {
+            size_t error_line = 0;
+            ready_queue = load_process_control_blocks_csv(pcb_file, &error_line);
+            if (ready_queue == NULL && error_line != 0)
+            {
+                printf("Error: \'%s\' line %zu is not a valid \'arrival,burst,priority\' record.\n", pcb_file, error_line);
+                finished = true;
+            }
+        }
+        else if (use_index)
+        {
+            // SJF and SRTF sort by arrival then burst, the other algorithms only by arrival
+            PcbOrder_t order = !run_all && (is_sjf(algorithm) || is_srtf(algorithm)) ? PCB_ORDER_ARRIVAL_BURST : PCB_ORDER_ARRIVAL;
+            bool index_rebuilt = false;
+            ready_queue = load_process_control_blocks_indexed(pcb_file, order, &index_rebuilt, &input_hash);
+            hashed = ready_queue != NULL;
+            if (ready_queue != NULL && index_rebuilt)
+            {
+                printf("Rebuilt the pcb index for %s\n", pcb_file);
+            }
+        }
+        else if (prefetch)
+        {
+            PcbReaderStats_t reader_stats = {0, 0, 0, 0};
+            ready_queue = load_process_control_blocks_prefetch(pcb_file, &reader_stats);
+            if (ready_queue != NULL)
+            {
+                print_reader_stats(&reader_stats);
+            }
+        }
+        else if (load_threads != 1)
+        {
+            ready_queue = load_process_control_blocks_parallel(pcb_file, load_threads);
+        }
+        else
+        {
+            ready_queue = load_process_control_blocks(pcb_file);
+        }
+        if (ready_queue == NULL && !finished)
+        {
+            printf("Error: Could not load the pcbs from \'%s\'.\n", pcb_file);
+        }
+        if (ready_queue != NULL)
+        {
+            phases.load_ns = monotonic_ns() - load_start;
+            end_memory_phase(&phase, memory);
+            if (counting)
+            {
+                perf_counters_stop(&phases.counters, &phases.load);
+            }
+            // Hashing the decoded pcbs rather than the file saves a second read of it, and a csv file and its transcode match
+            if (!hashed)
+            {
+                input_hash = pcb_content_hash((const ProcessControlBlock_t *)dyn_array_export(ready_queue), dyn_array_size(ready_queue));
+            }
+            // Covers the scheduler's scratch and the sort of its keys, plus the results, metrics, timeline and trace buffers
+            alloc_stats_begin(&phase, "schedule");
+        }
+    }
+
+    if (ready_queue != NULL && quanta != NULL)
+    {
+        bool success = run_quantum_sweep(ready_queue, quanta, quantum_count, &cost, jobs, pcb_file, input_hash, results_file);
+        end_memory_phase(&phase, memory);
+        status = success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    else if (ready_queue != NULL && run_all)
+    {
+        bool success = run_all_algorithms(ready_queue, quantum, &cost, percentiles, pcb_file, input_hash, results_file, timings ? &phases : NULL);
+        end_memory_phase(&phase, memory);
+        status = success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    else if (ready_queue != NULL)
+    {
+        sr = malloc(sizeof(ScheduleResult_t));
+        size_t process_count = dyn_array_size(ready_queue);
+        // The view schedulers are the ones that report per pcb metrics, timelines and the phases of the run or charge for switches
+        metrics = percentiles ? malloc(sizeof(PcbMetrics_t) * process_count) : NULL;
+        timeline = timeline_file ? schedule_timeline_create(TIMELINE_CAPACITY) : NULL;
+        // The trace is written to the file every time its ring fills up, so it holds every event however long the run
+        trace_out = trace_file ? fopen(trace_file, "wb") : NULL;
+        trace = trace_out ? schedule_trace_create(TRACE_CAPACITY, schedule_trace_write_events, trace_out) : NULL;
+        bool algorithm_result = sr != NULL && (!percentiles || metrics != NULL) && (!timeline_file || timeline != NULL) && (!trace_file || trace != NULL) &&
+                                run_view(algorithm_name, ready_queue, sr, quantum, &cost, metrics, timeline, trace, &phases);
+        end_memory_phase(&phase, memory);
+
+        if (algorithm_result)
+        {
+            uint64_t write_start = monotonic_ns();
+            print_schedule_result(sr, NULL);
+            if (metrics != NULL)
+            {
+                print_schedule_percentiles(metrics, process_count, stdout);
+            }
+            if (timeline != NULL)
+            {
+                if (schedule_timeline_write_chrome_trace(timeline, algorithm_name, timeline_file))
+                {
+                    printf("Wrote %zu timeline segments to %s", timeline->size, timeline_file);
+                    if (timeline->dropped > 0)
+                    {
+                        printf(" (the oldest %llu were dropped)", (unsigned long long)timeline->dropped);
+                    }
+                    printf("\n");
+                }
+                else
+                {
+                    fprintf(stderr, "Error: Could not write the timeline to '%s'.\n", timeline_file);
+                }
+            }
+            if (trace != NULL)
+            {
+                schedule_trace_flush(trace);
+                if (!ferror(trace_out))
+                {
+                    printf("Wrote %llu trace events to %s\n", (unsigned long long)trace->head, trace_file);
+                }
+                else
+                {
+                    fprintf(stderr, "Error: Could not write the trace to '%s'.\n", trace_file);
+                }
+            }
+
+            ScheduleRecord_t record = {algorithm_name, is_rr(algorithm) ? quantum : 0, pcb_file, input_hash, process_count, sr};
+            save_schedule_result(&record, results_file, render_readme);
+            phases.write_ns = monotonic_ns() - write_start;
+            if (counting)
+            {
+                print_phase_counters(&phases);
+            }
+            if (timings)
+            {
+                print_phase_timings(algorithm_name, &phases, process_count);
+            }
+            status = EXIT_SUCCESS;
+        }
+        else
+        {
+            printf("There was an error running the %s algorithm.\n", algorithm);
+        }
+    }
+
+    schedule_timeline_destroy(timeline);
+    schedule_trace_destroy(trace);
+    if (counters)
+    {
+        perf_counters_close(&phases.counters);
+    }
+    if (trace_out != NULL)
+    {
+        fclose(trace_out);
+    }
+    free(metrics);
     free(sr);
     dyn_array_destroy(ready_queue);
+    free(quanta);
 
-    return EXIT_SUCCESS;
+    return status;
 }
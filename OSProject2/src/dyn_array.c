@@ -31,6 +31,62 @@
 // Gets the size (in bytes) of n dyn_array elements
 #define DYN_SIZE_N_ELEMS(dyn_array_ptr, n) ((dyn_array_ptr)->data_size * (n))
 
+// Operation counters, see dyn_array_stats_t. Compiled out unless DYN_ARRAY_STATS is defined, so the default build
+// pays nothing for them
+#ifdef DYN_ARRAY_STATS
+#include <stdatomic.h>
+
+// Totals over every array, relaxed atomics since arrays can be used from different threads at once
+static struct
+{
+    atomic_uint_fast64_t bytes_moved;
+    atomic_uint_fast64_t bytes_copied;
+    atomic_uint_fast64_t reallocs;
+    atomic_uint_fast64_t realloc_bytes;
+    atomic_uint_fast64_t comparisons;
+    atomic_size_t max_capacity;
+} dyn_global_stats;
+
+// Adds to one of an array's counters and the global one. The array may be const for the read only operations, the
+// counters aren't part of what it holds so they are updated through a cast
+#define DYN_STAT_ADD(dyn_array_ptr, field, amount)                                                             \
+    do                                                                                                         \
+    {                                                                                                          \
+        uint64_t dyn_stat_amount = (amount);                                                                   \
+        ((dyn_array_t *)(dyn_array_ptr))->stats.field += dyn_stat_amount;                                      \
+        atomic_fetch_add_explicit(&dyn_global_stats.field, dyn_stat_amount, memory_order_relaxed);             \
+    } while (0)
+
+// Records a new capacity if it's the biggest the array, or any array, has had
+static void dyn_stat_capacity(dyn_array_t *const dyn_array)
+{
+    if (dyn_array->capacity > dyn_array->stats.max_capacity)
+    {
+        dyn_array->stats.max_capacity = dyn_array->capacity;
+    }
+    size_t global = atomic_load_explicit(&dyn_global_stats.max_capacity, memory_order_relaxed);
+    while (dyn_array->capacity > global &&
+           !atomic_compare_exchange_weak_explicit(&dyn_global_stats.max_capacity, &global, dyn_array->capacity, memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+    }
+}
+#define DYN_STAT_CAPACITY(dyn_array_ptr) dyn_stat_capacity(dyn_array_ptr)
+
+// qsort has no context argument, so the comparator being counted is handed over per thread
+static _Thread_local int (*dyn_counted_compare)(const void *, const void *);
+static _Thread_local uint64_t dyn_compare_count;
+
+static int dyn_counting_compare(const void *a, const void *b)
+{
+    ++dyn_compare_count;
+    return dyn_counted_compare(a, b);
+}
+#else
+#define DYN_STAT_ADD(dyn_array_ptr, field, amount) ((void)0)
+#define DYN_STAT_CAPACITY(dyn_array_ptr) ((void)0)
+#endif
+
 // Modes of operation for dyn_shift
 typedef enum
 {
@@ -73,13 +129,15 @@ dyn_array_t *dyn_array_create(const size_t capacity, const size_t data_type_size
 
             // I had an idea... and it compiles
             // const members of a malloc'd struct are so annoying
-            memcpy(dyn_array, &((dyn_array_t){actual_capacity, 0, data_type_size, malloc(data_type_size * actual_capacity), destruct_func}),
+            memcpy(dyn_array, &((dyn_array_t){.capacity = actual_capacity, .size = 0, .data_size = data_type_size,
+                                                    .array = malloc(data_type_size * actual_capacity), .destructor = destruct_func}),
                    sizeof(dyn_array_t));
 
             if (dyn_array->array)
             {
                 // other malloc worked, yay!
                 // we're done?
+                DYN_STAT_CAPACITY(dyn_array);
                 return dyn_array;
             }
             free(dyn_array);
@@ -253,7 +311,33 @@ bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const voi
     // and it works exactly like we want it to
     if (dyn_array && dyn_array->size && compare)
     {
+#ifdef DYN_ARRAY_STATS
+        dyn_counted_compare = compare;
+        dyn_compare_count = 0;
+        qsort(dyn_array->array, dyn_array->size, dyn_array->data_size, dyn_counting_compare);
+        DYN_STAT_ADD(dyn_array, comparisons, dyn_compare_count);
+#else
         qsort(dyn_array->array, dyn_array->size, dyn_array->data_size, compare);
+#endif
+        return true;
+    }
+    return false;
+}
+
+bool dyn_array_is_sorted(const dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *))
+{
+    if (dyn_array && compare)
+    {
+        // One pass comparing neighbours, bails out on the first pair that's out of order
+        for (size_t idx = 1; idx < dyn_array->size; ++idx)
+        {
+            if (compare(DYN_ARRAY_POSITION(dyn_array, idx - 1), DYN_ARRAY_POSITION(dyn_array, idx)) > 0)
+            {
+                DYN_STAT_ADD(dyn_array, comparisons, idx);
+                return false;
+            }
+        }
+        DYN_STAT_ADD(dyn_array, comparisons, dyn_array->size ? dyn_array->size - 1 : 0);
         return true;
     }
     return false;
@@ -271,6 +355,8 @@ bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const obj
             {
                 ++ordered_position;
             }
+            // Every element passed over took a comparison, plus the one that stopped the search if it didn't run off the end
+            DYN_STAT_ADD(dyn_array, comparisons, ordered_position + (ordered_position < dyn_array->size));
         }
         return dyn_shift_insert(dyn_array, ordered_position, 1, MODE_INSERT, object);
     }
@@ -312,6 +398,54 @@ bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *c
     }
 */
 
+bool dyn_array_get_stats(const dyn_array_t *const dyn_array, dyn_array_stats_t *const stats)
+{
+    if (stats)
+    {
+        memset(stats, 0, sizeof(dyn_array_stats_t));
+#ifdef DYN_ARRAY_STATS
+        if (dyn_array)
+        {
+            *stats = dyn_array->stats;
+            return true;
+        }
+#else
+        (void)dyn_array;
+#endif
+    }
+    return false;
+}
+
+bool dyn_array_get_global_stats(dyn_array_stats_t *const stats)
+{
+    if (stats)
+    {
+        memset(stats, 0, sizeof(dyn_array_stats_t));
+#ifdef DYN_ARRAY_STATS
+        stats->bytes_moved = atomic_load_explicit(&dyn_global_stats.bytes_moved, memory_order_relaxed);
+        stats->bytes_copied = atomic_load_explicit(&dyn_global_stats.bytes_copied, memory_order_relaxed);
+        stats->reallocs = atomic_load_explicit(&dyn_global_stats.reallocs, memory_order_relaxed);
+        stats->realloc_bytes = atomic_load_explicit(&dyn_global_stats.realloc_bytes, memory_order_relaxed);
+        stats->comparisons = atomic_load_explicit(&dyn_global_stats.comparisons, memory_order_relaxed);
+        stats->max_capacity = atomic_load_explicit(&dyn_global_stats.max_capacity, memory_order_relaxed);
+        return true;
+#endif
+    }
+    return false;
+}
+
+void dyn_array_reset_global_stats(void)
+{
+#ifdef DYN_ARRAY_STATS
+    atomic_store_explicit(&dyn_global_stats.bytes_moved, 0, memory_order_relaxed);
+    atomic_store_explicit(&dyn_global_stats.bytes_copied, 0, memory_order_relaxed);
+    atomic_store_explicit(&dyn_global_stats.reallocs, 0, memory_order_relaxed);
+    atomic_store_explicit(&dyn_global_stats.realloc_bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&dyn_global_stats.comparisons, 0, memory_order_relaxed);
+    atomic_store_explicit(&dyn_global_stats.max_capacity, 0, memory_order_relaxed);
+#endif
+}
+
 //
 ///
 // HERE BE DRAGONS
@@ -345,8 +479,10 @@ bool dyn_shift_insert(dyn_array_t *const dyn_array, const size_t position, const
             { // wasn't a gap at the end, we need to move data
                 memmove(DYN_ARRAY_POSITION(dyn_array, position + count), DYN_ARRAY_POSITION(dyn_array, position),
                         DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - position));
+                DYN_STAT_ADD(dyn_array, bytes_moved, DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - position));
             }
             memcpy(DYN_ARRAY_POSITION(dyn_array, position), data_src, dyn_array->data_size * count);
+            DYN_STAT_ADD(dyn_array, bytes_copied, dyn_array->data_size * count);
             dyn_array->size += count;
             return true;
         }
@@ -384,6 +520,7 @@ bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const
             if (data_dst)
             {
                 memcpy(data_dst, DYN_ARRAY_POSITION(dyn_array, position), dyn_array->data_size * count);
+                DYN_STAT_ADD(dyn_array, bytes_copied, dyn_array->data_size * count);
             }
             else
             {
@@ -398,6 +535,7 @@ bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const
             // there's a actual gap, not just a hole to make at the end
             memmove(DYN_ARRAY_POSITION(dyn_array, position), DYN_ARRAY_POSITION(dyn_array, position + count),
                     DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - (position + count)));
+            DYN_STAT_ADD(dyn_array, bytes_moved, DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - (position + count)));
         }
         // decrease the size and return
         dyn_array->size -= count;
@@ -442,6 +580,9 @@ bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increm
                 // success! Wasn't that easy?
                 dyn_array->array = new_array;
                 dyn_array->capacity = new_capacity;
+                DYN_STAT_ADD(dyn_array, reallocs, 1);
+                DYN_STAT_ADD(dyn_array, realloc_bytes, new_capacity * dyn_array->data_size);
+                DYN_STAT_CAPACITY(dyn_array);
                 return true;
             }
         }
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcb_index.h"
+#include "utilities.h"
+
+// Sidecar layout: magic, content hash, pcb count, then one uint32_t permutation of 'count' file positions per PcbOrder_t
+#define PCB_INDEX_MAGIC "PCBIDX1"
+#define PCB_INDEX_MAGIC_SIZE 8
+#define PCB_INDEX_HEADER_SIZE (PCB_INDEX_MAGIC_SIZE + sizeof(uint64_t) + sizeof(uint32_t))
+
+// Sort key for building a permutation, the file position breaks ties so the index is deterministic
+typedef struct
+{
+    uint64_t arrival;
+    uint64_t burst;
+    uint32_t position;
+} pcb_sort_key_t;
+
+char *pcb_index_path(const char *input_file)
+{
+    if (input_file == NULL)
+    {
+        return NULL;
+    }
+    size_t length = strlen(input_file);
+    char *path = malloc(length + 5);
+    if (path != NULL)
+    {
+        memcpy(path, input_file, length);
+        memcpy(path + length, ".idx", 5);
+    }
+    return path;
+}
+
+uint64_t pcb_content_hash_update(uint64_t hash, const ProcessControlBlock_t *pcbs, size_t count)
+{
+    // FNV-1a applied a field at a time rather than a byte at a time, it's 4x fewer multiplies on big traces
+    for (size_t i = 0; i < count; i++)
+    {
+        hash = (hash ^ pcbs[i].remaining_burst_time) * FNV_PRIME;
+        hash = (hash ^ pcbs[i].priority) * FNV_PRIME;
+        hash = (hash ^ pcbs[i].arrival) * FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t pcb_content_hash(const ProcessControlBlock_t *pcbs, size_t count)
+{
+    return (pcb_content_hash_update(FNV_OFFSET_BASIS, pcbs, count) ^ count) * FNV_PRIME;
+}
+
+static int compare_key_arrival(const void *a, const void *b)
+{
+    const pcb_sort_key_t *key_a = (const pcb_sort_key_t *)a;
+    const pcb_sort_key_t *key_b = (const pcb_sort_key_t *)b;
+    if (key_a->arrival != key_b->arrival)
+    {
+        return key_a->arrival < key_b->arrival ? -1 : 1;
+    }
+    return key_a->position < key_b->position ? -1 : (key_a->position > key_b->position);
+}
+
+static int compare_key_arrival_burst(const void *a, const void *b)
+{
+    const pcb_sort_key_t *key_a = (const pcb_sort_key_t *)a;
+    const pcb_sort_key_t *key_b = (const pcb_sort_key_t *)b;
+    if (key_a->arrival != key_b->arrival)
+    {
+        return key_a->arrival < key_b->arrival ? -1 : 1;
+    }
+    if (key_a->burst != key_b->burst)
+    {
+        return key_a->burst < key_b->burst ? -1 : 1;
+    }
+    return key_a->position < key_b->position ? -1 : (key_a->position > key_b->position);
+}
+
+// Sorts the pcbs' file positions into every ordering, 'orders' holds PCB_ORDER_COUNT * count entries
+static bool build_orders(const ProcessControlBlock_t *pcbs, uint32_t count, uint32_t *orders)
+{
+    pcb_sort_key_t *keys = malloc(sizeof(pcb_sort_key_t) * count);
+    if (keys == NULL)
+    {
+        return false;
+    }
+    int (*comparators[PCB_ORDER_COUNT])(const void *, const void *) = {compare_key_arrival, compare_key_arrival_burst};
+    for (size_t order = 0; order < PCB_ORDER_COUNT; order++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            keys[i] = (pcb_sort_key_t){pcbs[i].arrival, pcbs[i].remaining_burst_time, i};
+        }
+        qsort(keys, count, sizeof(pcb_sort_key_t), comparators[order]);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            orders[order * count + i] = keys[i].position;
+        }
+    }
+    free(keys);
+    return true;
+}
+
+// Writes the sidecar to a temporary file and renames it over the old one so readers never see a partial index
+static bool write_index(const char *index_path, uint64_t hash, uint32_t count, const uint32_t *orders)
+{
+    size_t length = strlen(index_path);
+    char *temporary_path = malloc(length + 5);
+    if (temporary_path == NULL)
+    {
+        return false;
+    }
+    memcpy(temporary_path, index_path, length);
+    memcpy(temporary_path + length, ".tmp", 5);
+
+    FILE *fp = fopen(temporary_path, "wb");
+    bool success = fp != NULL;
+    if (success)
+    {
+        char magic[PCB_INDEX_MAGIC_SIZE] = PCB_INDEX_MAGIC;
+        success = fwrite(magic, 1, PCB_INDEX_MAGIC_SIZE, fp) == PCB_INDEX_MAGIC_SIZE;
+        success = success && fwrite(&hash, sizeof(uint64_t), 1, fp) == 1;
+        success = success && fwrite(&count, sizeof(uint32_t), 1, fp) == 1;
+        success = success && fwrite(orders, sizeof(uint32_t), (size_t)count * PCB_ORDER_COUNT, fp) == (size_t)count * PCB_ORDER_COUNT;
+        success = fclose(fp) == 0 && success;
+    }
+    success = success && rename(temporary_path, index_path) == 0;
+    if (!success)
+    {
+        remove(temporary_path);
+    }
+    free(temporary_path);
+    return success;
+}
+
+// Reads one permutation out of the sidecar, returns false if the sidecar is missing, stale or corrupt
+static bool read_index(const char *index_path, uint64_t hash, uint32_t count, PcbOrder_t order, uint32_t *permutation)
+{
+    FILE *fp = fopen(index_path, "rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+    char magic[PCB_INDEX_MAGIC_SIZE];
+    uint64_t stored_hash;
+    uint32_t stored_count;
+    bool valid = fread(magic, 1, PCB_INDEX_MAGIC_SIZE, fp) == PCB_INDEX_MAGIC_SIZE && memcmp(magic, PCB_INDEX_MAGIC, PCB_INDEX_MAGIC_SIZE) == 0;
+    valid = valid && fread(&stored_hash, sizeof(uint64_t), 1, fp) == 1 && stored_hash == hash;
+    valid = valid && fread(&stored_count, sizeof(uint32_t), 1, fp) == 1 && stored_count == count;
+    valid = valid && fseek(fp, (long)(PCB_INDEX_HEADER_SIZE + (size_t)order * count * sizeof(uint32_t)), SEEK_SET) == 0;
+    valid = valid && fread(permutation, sizeof(uint32_t), count, fp) == count;
+    fclose(fp);
+    if (!valid)
+    {
+        return false;
+    }
+    // Make sure every position shows up exactly once so a corrupt index can't duplicate or drop pcbs
+    uint8_t *seen = calloc((count + 7) / 8, 1);
+    if (seen == NULL)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; valid && i < count; i++)
+    {
+        uint32_t position = permutation[i];
+        valid = position < count && !(seen[position / 8] & (1 << (position % 8)));
+        if (valid)
+        {
+            seen[position / 8] |= (uint8_t)(1 << (position % 8));
+        }
+    }
+    free(seen);
+    return valid;
+}
+
+dyn_array_t *load_process_control_blocks_indexed(const char *input_file, PcbOrder_t order, bool *index_rebuilt, uint64_t *content_hash)
+{
+    if (index_rebuilt != NULL)
+    {
+        *index_rebuilt = false;
+    }
+    if (order >= PCB_ORDER_COUNT)
+    {
+        return NULL;
+    }
+    dyn_array_t *file_order = load_process_control_blocks(input_file);
+    if (file_order == NULL)
+    {
+        return NULL;
+    }
+    if (dyn_array_size(file_order) > UINT32_MAX)
+    {
+        dyn_array_destroy(file_order);
+        return NULL; // The sidecar stores 32 bit positions
+    }
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *)dyn_array_export(file_order);
+    uint32_t count = (uint32_t)dyn_array_size(file_order);
+    uint64_t hash = pcb_content_hash(pcbs, count);
+    if (content_hash != NULL)
+    {
+        *content_hash = hash;
+    }
+
+    char *index_path = pcb_index_path(input_file);
+    uint32_t *orders = malloc(sizeof(uint32_t) * count * PCB_ORDER_COUNT);
+    dyn_array_t *ordered = dyn_array_create(count, sizeof(ProcessControlBlock_t), NULL);
+    bool success = index_path != NULL && orders != NULL && ordered != NULL;
+    uint32_t *permutation = orders + (size_t)order * count;
+    if (success && !read_index(index_path, hash, count, order, permutation))
+    {
+        // Missing or stale, rebuild every ordering so the next run with a different algorithm hits the index too
+        success = build_orders(pcbs, count, orders);
+        if (success && index_rebuilt != NULL)
+        {
+            *index_rebuilt = true;
+        }
+        // Failing to save the index only costs the next run a sort, so it doesn't fail the load
+        if (success && !write_index(index_path, hash, count, orders))
+        {
+            fprintf(stderr, "Warning: could not write the pcb index %s\n", index_path);
+        }
+    }
+    if (success)
+    {
+        // Gather the pcbs in order straight into the new array's storage
+        ProcessControlBlock_t *destination = (ProcessControlBlock_t *)ordered->array;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            destination[i] = pcbs[permutation[i]];
+        }
+        ordered->size = count;
+    }
+    free(orders);
+    free(index_path);
+    dyn_array_destroy(file_order);
+    if (!success)
+    {
+        dyn_array_destroy(ordered);
+        return NULL;
+    }
+    return ordered;
+}
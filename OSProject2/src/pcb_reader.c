@@ -0,0 +1,389 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pcb_index.h"
+#include "pcb_reader.h"
+#include "utilities.h"
+
+#define PCB_READER_DEFAULT_RECORDS (1 << 16) // Records per buffer when the caller doesn't pick a size
+#define PCB_STREAM_CHUNK 4096                // Pcbs first_come_first_serve_prefetch decodes and schedules at a time
+
+// One of the two buffers the background thread and the consumer take turns on
+typedef struct
+{
+    void *records;     // burst, priority, arrival triples in the file's layout
+    size_t count;      // Number of records in the buffer once it is full
+    bool full;         // Set by the background thread, cleared by the consumer once it has been decoded
+} pcb_reader_buffer_t;
+
+struct pcb_reader
+{
+    int fd;
+    uint64_t pcb_count;
+    size_t field_size; // Bytes in each field of a record \ref PcbFileLayout_t
+    size_t buffer_records;
+    pcb_reader_buffer_t buffers[2];
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed; // Signalled whenever a buffer is filled or emptied, or the reader stops
+    bool stop;              // Set by pcb_reader_close to end the background thread early
+    bool failed;            // Set by the background thread when the file is short or unreadable
+
+    // Consumer side, only touched by the thread calling pcb_reader_read
+    size_t current;  // Index of the buffer being decoded
+    size_t position; // Next record to decode in the current buffer
+    size_t consumed; // Records decoded so far
+
+    PcbReaderStats_t stats;
+};
+
+// Reads exactly 'bytes' bytes unless the file ends or errors first, returns the number of bytes read
+static size_t read_fully(int fd, void *buffer, size_t bytes)
+{
+    size_t total = 0;
+    while (total < bytes)
+    {
+        ssize_t result = read(fd, (uint8_t *)buffer + total, bytes - total);
+        if (result <= 0)
+        {
+            break;
+        }
+        total += (size_t)result;
+    }
+    return total;
+}
+
+// Background thread, alternately fills the two buffers until every record is read
+static void *pcb_reader_fill(void *arg)
+{
+    pcb_reader_t *reader = (pcb_reader_t *)arg;
+    uint64_t remaining = reader->pcb_count;
+    size_t next = 0;
+    while (remaining > 0)
+    {
+        pcb_reader_buffer_t *buffer = &reader->buffers[next];
+
+        // Wait for the consumer to finish with the buffer before overwriting it
+        pthread_mutex_lock(&reader->lock);
+        while (buffer->full && !reader->stop)
+        {
+            pthread_cond_wait(&reader->changed, &reader->lock);
+        }
+        bool stop = reader->stop;
+        pthread_mutex_unlock(&reader->lock);
+        if (stop)
+        {
+            return NULL;
+        }
+
+        size_t records = remaining < reader->buffer_records ? remaining : reader->buffer_records;
+        size_t bytes = records * 3 * reader->field_size;
+        uint64_t start = monotonic_ns();
+        size_t bytes_read = read_fully(reader->fd, buffer->records, bytes);
+        uint64_t io_ns = monotonic_ns() - start;
+
+        pthread_mutex_lock(&reader->lock);
+        reader->stats.io_ns += io_ns;
+        reader->stats.bytes_read += bytes_read;
+        if (bytes_read != bytes)
+        {
+            reader->failed = true; // The file holds fewer records than its count says
+            pthread_cond_broadcast(&reader->changed);
+            pthread_mutex_unlock(&reader->lock);
+            return NULL;
+        }
+        buffer->count = records;
+        buffer->full = true;
+        reader->stats.buffers++;
+        remaining -= records;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+
+        next ^= 1;
+    }
+    return NULL;
+}
+
+pcb_reader_t *pcb_reader_open(const char *input_file, size_t buffer_records)
+{
+    if (input_file == NULL)
+    {
+        return NULL;
+    }
+    pcb_reader_t *reader = calloc(1, sizeof(pcb_reader_t));
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+    reader->fd = open(input_file, O_RDONLY);
+    if (reader->fd < 0)
+    {
+        free(reader);
+        return NULL;
+    }
+    uint8_t header[PCB_FILE_HEADER_MAX];
+    struct stat file_stat; // The size tells a PCB64 file from an original one
+    PcbFileLayout_t layout;
+    if (fstat(reader->fd, &file_stat) != 0 || !pcb_file_layout(header, read_fully(reader->fd, header, PCB_FILE_HEADER_MAX), (uint64_t)file_stat.st_size, &layout) ||
+        lseek(reader->fd, (off_t)layout.header_size, SEEK_SET) < 0)
+    {
+        close(reader->fd);
+        free(reader);
+        return NULL; // Not even a count in the file
+    }
+    reader->pcb_count = layout.pcb_count;
+    reader->field_size = layout.field_size;
+    reader->buffer_records = buffer_records ? buffer_records : PCB_READER_DEFAULT_RECORDS;
+    if (reader->pcb_count > 0 && reader->buffer_records > reader->pcb_count)
+    {
+        reader->buffer_records = reader->pcb_count; // Don't allocate more than the whole file needs
+    }
+    reader->buffers[0].records = malloc(reader->buffer_records * 3 * reader->field_size);
+    reader->buffers[1].records = malloc(reader->buffer_records * 3 * reader->field_size);
+    if (reader->buffers[0].records == NULL || reader->buffers[1].records == NULL)
+    {
+        free(reader->buffers[0].records);
+        free(reader->buffers[1].records);
+        close(reader->fd);
+        free(reader);
+        return NULL;
+    }
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->changed, NULL);
+    if (pthread_create(&reader->thread, NULL, pcb_reader_fill, reader) != 0)
+    {
+        pthread_mutex_destroy(&reader->lock);
+        pthread_cond_destroy(&reader->changed);
+        free(reader->buffers[0].records);
+        free(reader->buffers[1].records);
+        close(reader->fd);
+        free(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+uint64_t pcb_reader_count(const pcb_reader_t *reader)
+{
+    return reader ? reader->pcb_count : 0;
+}
+
+size_t pcb_reader_read(pcb_reader_t *reader, ProcessControlBlock_t *pcbs, size_t max_count)
+{
+    if (reader == NULL || pcbs == NULL)
+    {
+        return 0;
+    }
+    size_t decoded = 0;
+    while (decoded < max_count && reader->consumed < reader->pcb_count)
+    {
+        pcb_reader_buffer_t *buffer = &reader->buffers[reader->current];
+        if (reader->position == 0)
+        {
+            // Starting on a new buffer, wait for the background thread if it hasn't filled it yet
+            pthread_mutex_lock(&reader->lock);
+            if (!buffer->full && !reader->failed)
+            {
+                uint64_t start = monotonic_ns();
+                while (!buffer->full && !reader->failed)
+                {
+                    pthread_cond_wait(&reader->changed, &reader->lock);
+                }
+                reader->stats.stall_ns += monotonic_ns() - start;
+            }
+            bool ready = buffer->full;
+            pthread_mutex_unlock(&reader->lock);
+            if (!ready)
+            {
+                break; // The background thread failed
+            }
+        }
+
+        size_t available = buffer->count - reader->position;
+        size_t records = max_count - decoded < available ? max_count - decoded : available;
+        const uint8_t *record = (const uint8_t *)buffer->records + reader->position * 3 * reader->field_size;
+        if (!decode_pcb_records(record, records, reader->field_size, &pcbs[decoded]))
+        {
+            pthread_mutex_lock(&reader->lock);
+            reader->failed = true; // A PCB64 record with a priority too big for a pcb
+            pthread_mutex_unlock(&reader->lock);
+            break;
+        }
+        decoded += records;
+        reader->position += records;
+        reader->consumed += records;
+
+        if (reader->position == buffer->count)
+        {
+            // Hand the buffer back to the background thread and move on to the other one
+            pthread_mutex_lock(&reader->lock);
+            buffer->full = false;
+            pthread_cond_broadcast(&reader->changed);
+            pthread_mutex_unlock(&reader->lock);
+            reader->current ^= 1;
+            reader->position = 0;
+        }
+    }
+    return decoded;
+}
+
+bool pcb_reader_failed(pcb_reader_t *reader)
+{
+    if (reader == NULL)
+    {
+        return true;
+    }
+    pthread_mutex_lock(&reader->lock);
+    bool failed = reader->failed;
+    pthread_mutex_unlock(&reader->lock);
+    return failed;
+}
+
+void pcb_reader_close(pcb_reader_t *reader, PcbReaderStats_t *stats)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&reader->lock);
+    reader->stop = true;
+    pthread_cond_broadcast(&reader->changed);
+    pthread_mutex_unlock(&reader->lock);
+    pthread_join(reader->thread, NULL);
+    if (stats != NULL)
+    {
+        *stats = reader->stats;
+    }
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->changed);
+    free(reader->buffers[0].records);
+    free(reader->buffers[1].records);
+    close(reader->fd);
+    free(reader);
+}
+
+dyn_array_t *load_process_control_blocks_prefetch(const char *input_file, PcbReaderStats_t *stats)
+{
+    if (stats != NULL)
+    {
+        memset(stats, 0, sizeof(PcbReaderStats_t));
+    }
+    pcb_reader_t *reader = pcb_reader_open(input_file, 0);
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+    uint64_t pcb_count = pcb_reader_count(reader);
+    dyn_array_t *dyn_array = pcb_count && pcb_count <= SIZE_MAX / sizeof(ProcessControlBlock_t)
+                                 ? dyn_array_create((size_t)pcb_count, sizeof(ProcessControlBlock_t), NULL)
+                                 : NULL;
+    if (dyn_array == NULL)
+    {
+        pcb_reader_close(reader, stats);
+        return NULL; // An empty file isn't valid either, matching load_process_control_blocks
+    }
+    // Decode straight into the array's storage, the background thread keeps reading ahead meanwhile
+    size_t decoded = 0;
+    size_t records;
+    while ((records = pcb_reader_read(reader, (ProcessControlBlock_t *)dyn_array->array + decoded, (size_t)pcb_count - decoded)) > 0)
+    {
+        decoded += records;
+    }
+    pcb_reader_close(reader, stats);
+    if (decoded != pcb_count)
+    {
+        dyn_array_destroy(dyn_array);
+        return NULL;
+    }
+    dyn_array->size = (size_t)pcb_count;
+    return dyn_array;
+}
+
+bool first_come_first_serve_prefetch(const char *input_file, ScheduleResult_t *result, size_t *process_count, uint64_t *content_hash,
+                                     bool *unsorted, PcbReaderStats_t *stats)
+{
+    if (stats != NULL)
+    {
+        memset(stats, 0, sizeof(PcbReaderStats_t));
+    }
+    if (unsorted != NULL)
+    {
+        *unsorted = false;
+    }
+    if (result == NULL || process_count == NULL)
+    {
+        return false;
+    }
+    pcb_reader_t *reader = pcb_reader_open(input_file, 0);
+    if (reader == NULL)
+    {
+        return false;
+    }
+    uint64_t pcb_count = pcb_reader_count(reader);
+    ProcessControlBlock_t *pcbs = pcb_count > 0 ? malloc(sizeof(ProcessControlBlock_t) * PCB_STREAM_CHUNK) : NULL;
+    if (pcbs == NULL)
+    {
+        pcb_reader_close(reader, stats);
+        return false; // An empty file isn't valid either, matching load_process_control_blocks
+    }
+    // The same totals as first_come_first_serve_view, which for pcbs in arrival order runs them in file order
+    uint64_t time = 0;
+    uint64_t total_turnaround_time = 0;
+    uint64_t total_waiting_time = 0;
+    uint64_t total_response_time = 0;
+    uint64_t last_arrival = 0;
+    uint64_t hash = FNV_OFFSET_BASIS;
+    uint64_t scheduled = 0;
+    bool in_order = true;
+    size_t records;
+    while (in_order && (records = pcb_reader_read(reader, pcbs, PCB_STREAM_CHUNK)) > 0)
+    {
+        for (size_t i = 0; i < records; i++)
+        {
+            if (pcbs[i].arrival < last_arrival)
+            {
+                in_order = false;
+                break;
+            }
+            last_arrival = pcbs[i].arrival;
+            if (time < pcbs[i].arrival)
+            {
+                time = pcbs[i].arrival;
+            }
+            total_response_time += time - pcbs[i].arrival;
+            time += pcbs[i].remaining_burst_time;
+            uint64_t turnaround_time = time - pcbs[i].arrival;
+            total_turnaround_time += turnaround_time;
+            total_waiting_time += turnaround_time - pcbs[i].remaining_burst_time;
+        }
+        hash = pcb_content_hash_update(hash, pcbs, records);
+        scheduled += records;
+    }
+    pcb_reader_close(reader, stats);
+    free(pcbs);
+    if (!in_order && unsorted != NULL)
+    {
+        *unsorted = true;
+    }
+    if (!in_order || scheduled != pcb_count)
+    {
+        return false;
+    }
+    result->average_turnaround_time = (double)total_turnaround_time / scheduled;
+    result->average_waiting_time = (double)total_waiting_time / scheduled;
+    result->total_run_time = time;
+    result->average_response_time = (double)total_response_time / scheduled;
+    result->context_switches = scheduled - 1; // Non preemptive, the cpu switches once between consecutive pcbs
+    result->overhead_time = 0;
+    *process_count = (size_t)scheduled;
+    if (content_hash != NULL)
+    {
+        *content_hash = (hash ^ scheduled) * FNV_PRIME;
+    }
+    return true;
+}
@@ -0,0 +1,131 @@
+#define _GNU_SOURCE // Needed for syscall with -std=c11
+
+#include <inttypes.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "perf_counters.h"
+
+// The perf event behind each counter
+static const struct
+{
+    uint32_t type;
+    uint64_t config;
+    const char *name;
+} perf_counter_events[PERF_COUNTER_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), "L1d-misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "LLC-misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch-misses"},
+};
+
+bool perf_counters_open(PerfCounters_t *counters)
+{
+    bool any = false;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perf_counter_events[i].type;
+        attr.config = perf_counter_events[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;        // Also count the loader threads
+        attr.exclude_kernel = 1; // User space is all an unprivileged process may count
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // There is no glibc wrapper, this process on any cpu
+        counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        any = any || counters->fds[i] >= 0;
+    }
+    return any;
+}
+
+void perf_counters_close(PerfCounters_t *counters)
+{
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        if (counters->fds[i] >= 0)
+        {
+            close(counters->fds[i]);
+            counters->fds[i] = -1;
+        }
+    }
+}
+
+void perf_counters_start(PerfCounters_t *counters)
+{
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        if (counters->fds[i] >= 0)
+        {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void perf_counters_stop(PerfCounters_t *counters, PerfCounterValues_t *values)
+{
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        if (counters->fds[i] >= 0)
+        {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        uint64_t data[3]; // The count, the time enabled and the time actually counting
+        values->valid[i] = counters->fds[i] >= 0 && read(counters->fds[i], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2] > 0;
+        values->values[i] = 0;
+        if (values->valid[i])
+        {
+            // Extrapolate if the counter only got the pmu for part of the time
+            values->values[i] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+        }
+    }
+}
+
+void perf_counters_add(PerfCounterValues_t *total, const PerfCounterValues_t *values)
+{
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        total->values[i] += values->values[i];
+        total->valid[i] = total->valid[i] && values->valid[i];
+    }
+}
+
+const char *perf_counter_name(PerfCounter_t counter)
+{
+    return counter < PERF_COUNTER_COUNT ? perf_counter_events[counter].name : "unknown";
+}
+
+void perf_counters_print(const char *label, const PerfCounterValues_t *values, FILE *fp)
+{
+    fprintf(fp, "%-10s", label);
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        if (values->valid[i])
+        {
+            fprintf(fp, " %14" PRIu64, values->values[i]);
+        }
+        else
+        {
+            fprintf(fp, " %14s", "n/a");
+        }
+    }
+    if (values->valid[PERF_COUNTER_CYCLES] && values->valid[PERF_COUNTER_INSTRUCTIONS] && values->values[PERF_COUNTER_CYCLES] > 0)
+    {
+        fprintf(fp, " %6.2f", (double)values->values[PERF_COUNTER_INSTRUCTIONS] / values->values[PERF_COUNTER_CYCLES]);
+    }
+    else
+    {
+        fprintf(fp, " %6s", "n/a");
+    }
+    fprintf(fp, "\n");
+}
@@ -1,142 +1,838 @@
+#define _GNU_SOURCE // Needed for pread and sysconf(_SC_NPROCESSORS_ONLN) with -std=c11
+
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "dyn_array.h"
 #include "processing_scheduling.h"
 #include "utilities.h"
 
-// Private function for decreasing the execution time of a process
-void virtual_cpu(ProcessControlBlock_t *process_control_block, uint32_t execution_time)
+// Forces a scheduling loop inline so the copy called without optional features compiles down to just the schedule
+#define SCHEDULE_ALWAYS_INLINE static inline __attribute__((always_inline))
+#define SCHEDULE_NEVER_RAN UINT64_MAX // Time off the cpu of a PCB that hasn't run yet
+
+// Sort key for putting PCBs in scheduling order without touching the caller's PCBs, the PCB's index breaks ties so
+// equal PCBs keep the order they were given in (the same order a stable sort of the ready queue would give)
+typedef struct
+{
+    uint64_t arrival;
+    uint64_t burst;
+    uint32_t index;
+} schedule_key_t;
+
+// SRTF ready queue entry, ordered by remaining time and then newest arrival first
+typedef struct
+{
+    uint64_t remaining;
+    uint32_t sequence; // Order the entry joined the ready queue in
+    uint32_t position; // Position of the PCB in the sorted keys
+} srtf_entry_t;
+
+// View scheduler counters, see ScheduleStats_t. A run counts into its thread's own copy and adds it to the totals
+// when it finishes, so the loops don't pay for atomics.
+#ifdef DYN_ARRAY_STATS
+#include <stdatomic.h>
+
+static struct
+{
+    atomic_uint_fast64_t sort_comparisons;
+    atomic_uint_fast64_t queue_moves;
+    atomic_uint_fast64_t queue_bytes_moved;
+} schedule_global_stats;
+
+static _Thread_local ScheduleStats_t schedule_run_stats;
+
+// qsort has no context argument, so the comparator being counted is handed over per thread
+static _Thread_local int (*schedule_counted_compare)(const void *, const void *);
+
+static int schedule_counting_compare(const void *a, const void *b)
 {
-    // Decrement burst time of the PCB
-    process_control_block->remaining_burst_time = process_control_block->remaining_burst_time - execution_time;
+    ++schedule_run_stats.sort_comparisons;
+    return schedule_counted_compare(a, b);
 }
 
-bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result)
+// Private function that adds the finished run's counts to the totals
+static void schedule_stats_flush(void)
 {
-    // Invalid Params
-    if(ready_queue == NULL || result == NULL) return false;
-    
-    //Number of processes in the ready_queue
-    size_t num_processes = dyn_array_size(ready_queue);
+    atomic_fetch_add_explicit(&schedule_global_stats.sort_comparisons, schedule_run_stats.sort_comparisons, memory_order_relaxed);
+    atomic_fetch_add_explicit(&schedule_global_stats.queue_moves, schedule_run_stats.queue_moves, memory_order_relaxed);
+    atomic_fetch_add_explicit(&schedule_global_stats.queue_bytes_moved, schedule_run_stats.queue_bytes_moved, memory_order_relaxed);
+    memset(&schedule_run_stats, 0, sizeof(ScheduleStats_t));
+}
+#define SCHEDULE_STAT_COMPARISON() (++schedule_run_stats.sort_comparisons)
+#define SCHEDULE_STAT_MOVE(entry_size) (++schedule_run_stats.queue_moves, schedule_run_stats.queue_bytes_moved += (entry_size))
+#define SCHEDULE_STAT_FLUSH() schedule_stats_flush()
+#else
+#define SCHEDULE_STAT_COMPARISON() ((void)0)
+#define SCHEDULE_STAT_MOVE(entry_size) ((void)0)
+#define SCHEDULE_STAT_FLUSH() ((void)0)
+#endif
 
-    //Sort based on arrival (assuming processes can be in any order in the ready_queue)
-    dyn_array_sort(ready_queue, compare_arrival);
+bool schedule_get_global_stats(ScheduleStats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+#ifdef DYN_ARRAY_STATS
+    stats->sort_comparisons = atomic_load_explicit(&schedule_global_stats.sort_comparisons, memory_order_relaxed);
+    stats->queue_moves = atomic_load_explicit(&schedule_global_stats.queue_moves, memory_order_relaxed);
+    stats->queue_bytes_moved = atomic_load_explicit(&schedule_global_stats.queue_bytes_moved, memory_order_relaxed);
+    return true;
+#else
+    memset(stats, 0, sizeof(ScheduleStats_t));
+    return false;
+#endif
+}
 
-    // No processes
-    if(num_processes == 0) return false;
+void schedule_reset_global_stats(void)
+{
+#ifdef DYN_ARRAY_STATS
+    atomic_store_explicit(&schedule_global_stats.sort_comparisons, 0, memory_order_relaxed);
+    atomic_store_explicit(&schedule_global_stats.queue_moves, 0, memory_order_relaxed);
+    atomic_store_explicit(&schedule_global_stats.queue_bytes_moved, 0, memory_order_relaxed);
+#endif
+}
 
-    // Initialize variables for tracking statistics
-    float total_waiting_time = 0.0;
-    float total_turnaround_time = 0.0;
-    unsigned long total_run_time = 0;
-    
-    // Iterate through the processes
-    for(size_t i = 0; i < num_processes; ++i){
-        ProcessControlBlock_t *pcb = dyn_array_at(ready_queue, i);
+static int compare_key_arrival(const void *a, const void *b)
+{
+    const schedule_key_t *key_a = (const schedule_key_t *)a;
+    const schedule_key_t *key_b = (const schedule_key_t *)b;
+    if (key_a->arrival != key_b->arrival)
+    {
+        return key_a->arrival < key_b->arrival ? -1 : 1;
+    }
+    return key_a->index < key_b->index ? -1 : (key_a->index > key_b->index);
+}
 
-        // Mark PCB as started
-        pcb->started = true;
+static int compare_key_arrival_burst(const void *a, const void *b)
+{
+    const schedule_key_t *key_a = (const schedule_key_t *)a;
+    const schedule_key_t *key_b = (const schedule_key_t *)b;
+    if (key_a->arrival != key_b->arrival)
+    {
+        return key_a->arrival < key_b->arrival ? -1 : 1;
+    }
+    if (key_a->burst != key_b->burst)
+    {
+        return key_a->burst < key_b->burst ? -1 : 1;
+    }
+    return key_a->index < key_b->index ? -1 : (key_a->index > key_b->index);
+}
 
-        // If pcb hasn't "arrived" yet, fast forward to its arrival
-        if(total_run_time < pcb->arrival) 
+// Private function that fills the scratch keys in arrival (and optionally burst) order, the sort is skipped when the
+// PCBs were given in order already (e.g. loaded through a pcb index)
+static void sort_schedule_keys(const ProcessControlBlock_t *pcbs, size_t count, schedule_key_t *keys, int (*compare)(const void *, const void *))
+{
+    bool sorted = true;
+    for (size_t i = 0; i < count; i++)
+    {
+        keys[i] = (schedule_key_t){pcbs[i].arrival, pcbs[i].remaining_burst_time, (uint32_t)i};
+        if (sorted && i > 0)
         {
-            total_run_time = pcb->arrival;
+            SCHEDULE_STAT_COMPARISON();
+            sorted = compare(&keys[i - 1], &keys[i]) <= 0;
         }
+    }
+    if (!sorted)
+    {
+#ifdef DYN_ARRAY_STATS
+        schedule_counted_compare = compare;
+        compare = schedule_counting_compare;
+#endif
+        qsort(keys, count, sizeof(schedule_key_t), compare);
+    }
+}
 
-        // Update statistics
-        total_run_time += pcb->remaining_burst_time;
-        float turnaround_time = total_run_time - pcb->arrival;
-        total_turnaround_time += turnaround_time;
-        total_waiting_time += turnaround_time - pcb->remaining_burst_time;
+// Private function that checks the arguments every view scheduler shares and hands back the scratch keys
+static schedule_key_t *schedule_view_keys(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, ScheduleContext_t *context)
+{
+    if (pcbs == NULL || count == 0 || count > UINT32_MAX || result == NULL || context == NULL || context->scratch == NULL ||
+        context->scratch_size < schedule_scratch_size(count))
+    {
+        return NULL;
+    }
+    return (schedule_key_t *)context->scratch;
+}
+
+// Private function for turning the schedule totals into the averages reported in the result
+static void write_view_result(ScheduleResult_t *result, uint64_t total_turnaround_time, uint64_t total_waiting_time, uint64_t total_response_time,
+                              uint64_t context_switches, uint64_t overhead_time, uint64_t total_run_time, size_t count)
+{
+    result->average_turnaround_time = (double)total_turnaround_time / count;
+    result->average_waiting_time = (double)total_waiting_time / count;
+    result->total_run_time = total_run_time;
+    result->average_response_time = (double)total_response_time / count;
+    result->context_switches = context_switches;
+    result->overhead_time = overhead_time;
+}
+
+size_t schedule_scratch_size(size_t count)
+{
+    // Sorted keys, followed by the largest per algorithm queue (SRTF's entries, which also cover RR's ring and remaining
+    // times) and the times the PCBs last came off the cpu for the cost model
+    return count * (sizeof(schedule_key_t) + sizeof(srtf_entry_t) + sizeof(uint64_t));
+}
 
-        // Execute the process
-        virtual_cpu(pcb, pcb->remaining_burst_time);
+// Private function that finds the cost model's per PCB stop times at the end of the scratch, the two parts before it
+// add up to a multiple of 8 bytes so the times are aligned
+static inline uint64_t *schedule_stop_times(const schedule_key_t *keys, size_t count)
+{
+    return (uint64_t *)((uint8_t *)keys + count * (sizeof(schedule_key_t) + sizeof(srtf_entry_t)));
+}
 
-        // Mark PCB as completed
-        pcb->completed = true;
+void schedule_context_init(ScheduleContext_t *context, void *scratch, size_t scratch_size)
+{
+    if (context == NULL)
+    {
+        return;
     }
-    
-    // Update the result structure with calculated averages
-    write_schedule_result(result, total_turnaround_time, total_waiting_time, total_run_time, num_processes);
+    memset(context, 0, sizeof(ScheduleContext_t));
+    context->scratch = scratch;
+    context->scratch_size = scratch_size;
+}
 
-    return true;
+// Private function that records when a PCB first got the cpu, only called with metrics turned on
+static inline void note_first_run(PcbMetrics_t *metrics, const schedule_key_t *key, uint64_t time)
+{
+    metrics[key->index].first_run = time;
 }
 
-bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
+// Private function that fills in the rest of a PCB's metrics once it completes, only called with metrics turned on
+static inline void note_completion(PcbMetrics_t *metrics, const schedule_key_t *key, uint64_t time)
 {
-    // Error checking
-    if (ready_queue == NULL || result == NULL || dyn_array_size(ready_queue) == 0)
+    PcbMetrics_t *pcb_metrics = &metrics[key->index];
+    pcb_metrics->completion = time;
+    pcb_metrics->turnaround = time - key->arrival;
+    pcb_metrics->waiting = pcb_metrics->turnaround - key->burst;
+    pcb_metrics->response = pcb_metrics->first_run - key->arrival;
+}
+
+// Private function that adds a stretch of a PCB running to the timeline, only called with a timeline turned on
+static inline void note_run(ScheduleTimeline_t *timeline, const schedule_key_t *key, uint64_t start, uint64_t end)
+{
+    if (end > start)
+    {
+        schedule_timeline_record(timeline, key->index, 0, start, end);
+    }
+}
+
+// Private function that adds an event to the trace, only called with a trace turned on
+static inline void note_event(ScheduleTrace_t *trace, ScheduleEventType_t type, const schedule_key_t *key, uint64_t time)
+{
+    schedule_trace_record(trace, type, key->index, time);
+}
+
+// Private function that tells the context's phase callback where a run has got to, once per phase so it stays out of
+// the scheduling loops
+static inline void note_phase(const ScheduleContext_t *context, SchedulePhase_t phase)
+{
+    if (context->phase != NULL)
+    {
+        context->phase(phase, context->phase_arg);
+    }
+}
+
+// Private function that checks if a cost model charges anything for switching
+static inline bool schedule_cost_enabled(const ScheduleCostModel_t *cost)
+{
+    return cost->switch_cost != 0 || cost->cold_cache_penalty != 0;
+}
+
+// Private function that works out what switching to a PCB costs given how long it has been off the cpu
+static inline uint64_t dispatch_cost(const ScheduleCostModel_t *cost, uint64_t time_away)
+{
+    uint64_t penalty = cost->cold_cache_penalty;
+    if (time_away < cost->cold_cache_window)
+    {
+        penalty = penalty * time_away / cost->cold_cache_window; // Still partly warm
+    }
+    return cost->switch_cost + penalty;
+}
+
+// Private function that checks if a context asks for any of the optional per run recording or a cost model
+static inline bool schedule_hooks_enabled(const ScheduleContext_t *context)
+{
+    return context->metrics != NULL || context->timeline != NULL || context->trace != NULL || schedule_cost_enabled(&context->cost);
+}
+
+// The scheduling loops below take the context's optional recording and cost model as a parameter and are forced
+// inline into their view function, which calls them once with the context and once with a literal NULL. The NULL copy
+// has every optional branch folded away, so schedules without metrics, a timeline, a trace or switch costs pay nothing
+// for them, and with the context each costs one predictable branch per use.
+// Switch overhead runs the clock before the PCB switched to starts, so it shows up in waiting and response times.
+
+SCHEDULE_ALWAYS_INLINE void first_come_first_serve_run(const schedule_key_t *keys, size_t count, ScheduleResult_t *result, const ScheduleContext_t *hooks)
+{
+    bool charge = hooks && schedule_cost_enabled(&hooks->cost);
+    uint64_t time = 0;
+    uint64_t total_turnaround_time = 0;
+    uint64_t total_waiting_time = 0;
+    uint64_t total_response_time = 0;
+    uint64_t overhead_time = 0;
+    size_t traced = 0; // Next pcb whose arrival hasn't been traced
+    for (size_t i = 0; i < count; i++)
+    {
+        // If the pcb hasn't "arrived" yet, fast forward to its arrival
+        if (time < keys[i].arrival)
+        {
+            time = keys[i].arrival;
+        }
+        if (charge && i > 0)
+        {
+            // Every pcb after the first is a switch to one that has never run
+            uint64_t overhead = dispatch_cost(&hooks->cost, SCHEDULE_NEVER_RAN);
+            time += overhead;
+            overhead_time += overhead;
+        }
+        if (hooks && hooks->trace)
+        {
+            for (; traced < count && keys[traced].arrival <= time; traced++)
+            {
+                note_event(hooks->trace, SCHEDULE_EVENT_ARRIVE, &keys[traced], keys[traced].arrival);
+            }
+            note_event(hooks->trace, SCHEDULE_EVENT_DISPATCH, &keys[i], time);
+        }
+        total_response_time += time - keys[i].arrival;
+        if (hooks && hooks->metrics)
+        {
+            note_first_run(hooks->metrics, &keys[i], time);
+        }
+        time += keys[i].burst;
+        if (hooks && hooks->timeline)
+        {
+            note_run(hooks->timeline, &keys[i], time - keys[i].burst, time);
+        }
+        uint64_t turnaround_time = time - keys[i].arrival;
+        total_turnaround_time += turnaround_time;
+        total_waiting_time += turnaround_time - keys[i].burst;
+        if (hooks && hooks->metrics)
+        {
+            note_completion(hooks->metrics, &keys[i], time);
+        }
+        if (hooks && hooks->trace)
+        {
+            note_event(hooks->trace, SCHEDULE_EVENT_COMPLETE, &keys[i], time);
+        }
+    }
+    // Non preemptive, the cpu switches once between consecutive pcbs
+    write_view_result(result, total_turnaround_time, total_waiting_time, total_response_time, count - 1, overhead_time, time, count);
+}
+
+bool first_come_first_serve_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, ScheduleContext_t *context)
+{
+    schedule_key_t *keys = schedule_view_keys(pcbs, count, result, context);
+    if (keys == NULL)
+    {
         return false;
+    }
+    note_phase(context, SCHEDULE_PHASE_SORT);
+    sort_schedule_keys(pcbs, count, keys, compare_key_arrival);
+    note_phase(context, SCHEDULE_PHASE_RUN);
+    if (schedule_hooks_enabled(context))
+    {
+        first_come_first_serve_run(keys, count, result, context);
+    }
+    else
+    {
+        first_come_first_serve_run(keys, count, result, NULL);
+    }
+    note_phase(context, SCHEDULE_PHASE_DONE);
+    SCHEDULE_STAT_FLUSH();
+    return true;
+}
 
-    // Sort the ready queue based on remaining burst time (shortest job first)
-    dyn_array_sort(ready_queue, compare_arrival_burst);
+// SJF ready queue order, shortest burst first and then earliest in arrival order
+static inline bool sjf_before(const schedule_key_t *keys, uint32_t a, uint32_t b)
+{
+    return keys[a].burst != keys[b].burst ? keys[a].burst < keys[b].burst : a < b;
+}
 
-    // Initialize variables for tracking statistics
-    float total_waiting_time = 0.0;
-    float total_turnaround_time = 0.0;
-    unsigned long total_run_time = 0;
-    int starting_queue_size = dyn_array_size(ready_queue);
+SCHEDULE_ALWAYS_INLINE void shortest_job_first_run(const schedule_key_t *keys, size_t count, ScheduleResult_t *result, const ScheduleContext_t *hooks)
+{
+    // Binary min heap of the arrived PCBs' positions in the sorted keys
+    uint32_t *heap = (uint32_t *)(keys + count);
+    size_t heap_size = 0;
+    size_t next = 0; // Next PCB to arrive
+    bool charge = hooks && schedule_cost_enabled(&hooks->cost);
+    uint64_t time = 0;
+    uint64_t total_turnaround_time = 0;
+    uint64_t total_waiting_time = 0;
+    uint64_t total_response_time = 0;
+    uint64_t overhead_time = 0;
+    while (heap_size > 0 || next < count)
+    {
+        // If nothing is waiting, fast forward to the next arrival
+        if (heap_size == 0 && time < keys[next].arrival)
+        {
+            time = keys[next].arrival;
+        }
+        // Admit everything that has arrived by now
+        for (; next < count && keys[next].arrival <= time; next++)
+        {
+            if (hooks && hooks->trace)
+            {
+                note_event(hooks->trace, SCHEDULE_EVENT_ARRIVE, &keys[next], keys[next].arrival);
+            }
+            size_t child = heap_size++;
+            while (child > 0 && sjf_before(keys, (uint32_t)next, heap[(child - 1) / 2]))
+            {
+                heap[child] = heap[(child - 1) / 2];
+                SCHEDULE_STAT_MOVE(sizeof(uint32_t));
+                child = (child - 1) / 2;
+            }
+            heap[child] = (uint32_t)next;
+            SCHEDULE_STAT_MOVE(sizeof(uint32_t));
+        }
+
+        // Run the shortest job to completion, after switching to it unless nothing has run yet (every admitted pcb
+        // that isn't waiting has run)
+        const schedule_key_t *key = &keys[heap[0]];
+        if (charge && next > heap_size)
+        {
+            uint64_t overhead = dispatch_cost(&hooks->cost, SCHEDULE_NEVER_RAN);
+            time += overhead;
+            overhead_time += overhead;
+        }
+        if (hooks && hooks->trace)
+        {
+            note_event(hooks->trace, SCHEDULE_EVENT_DISPATCH, key, time);
+        }
+        total_response_time += time - key->arrival;
+        if (hooks && hooks->metrics)
+        {
+            note_first_run(hooks->metrics, key, time);
+        }
+        time += key->burst;
+        if (hooks && hooks->timeline)
+        {
+            note_run(hooks->timeline, key, time - key->burst, time);
+        }
+        uint64_t turnaround_time = time - key->arrival;
+        total_turnaround_time += turnaround_time;
+        total_waiting_time += turnaround_time - key->burst;
+        if (hooks && hooks->metrics)
+        {
+            note_completion(hooks->metrics, key, time);
+        }
+        if (hooks && hooks->trace)
+        {
+            note_event(hooks->trace, SCHEDULE_EVENT_COMPLETE, key, time);
+        }
+
+        // Pop it by sifting the last entry down from the root
+        uint32_t last = heap[--heap_size];
+        size_t parent = 0;
+        for (size_t child = 1; child < heap_size; child = 2 * parent + 1)
+        {
+            if (child + 1 < heap_size && sjf_before(keys, heap[child + 1], heap[child]))
+            {
+                child++;
+            }
+            if (!sjf_before(keys, heap[child], last))
+            {
+                break;
+            }
+            heap[parent] = heap[child];
+            SCHEDULE_STAT_MOVE(sizeof(uint32_t));
+            parent = child;
+        }
+        heap[parent] = last;
+        SCHEDULE_STAT_MOVE(sizeof(uint32_t));
+    }
+    // Non preemptive, the cpu switches once between consecutive pcbs
+    write_view_result(result, total_turnaround_time, total_waiting_time, total_response_time, count - 1, overhead_time, time, count);
+}
+
+bool shortest_job_first_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, ScheduleContext_t *context)
+{
+    schedule_key_t *keys = schedule_view_keys(pcbs, count, result, context);
+    if (keys == NULL)
+    {
+        return false;
+    }
+    note_phase(context, SCHEDULE_PHASE_SORT);
+    sort_schedule_keys(pcbs, count, keys, compare_key_arrival_burst);
+    note_phase(context, SCHEDULE_PHASE_RUN);
+    if (schedule_hooks_enabled(context))
+    {
+        shortest_job_first_run(keys, count, result, context);
+    }
+    else
+    {
+        shortest_job_first_run(keys, count, result, NULL);
+    }
+    note_phase(context, SCHEDULE_PHASE_DONE);
+    SCHEDULE_STAT_FLUSH();
+    return true;
+}
+
+SCHEDULE_ALWAYS_INLINE void round_robin_run(const schedule_key_t *keys, size_t count, ScheduleResult_t *result, size_t quantum, const ScheduleContext_t *hooks)
+{
+    // Ring of the arrived PCBs' positions in the sorted keys, every PCB is in it at most once so 'count' slots are enough
+    uint64_t *remaining = (uint64_t *)(keys + count);
+    uint32_t *ring = (uint32_t *)(remaining + count);
+    size_t head = 0;
+    size_t queued = 0;
 
-    // Process each PCB in the ready queue until all are removed
-    while (dyn_array_size(ready_queue) > 0)
+    // Only the first process is queued up front, the rest join at the end of a quantum
+    uint64_t time = keys[0].arrival;
+    remaining[0] = keys[0].burst;
+    ring[0] = 0;
+    SCHEDULE_STAT_MOVE(sizeof(uint32_t));
+    queued = 1;
+    size_t next = 1; // Next PCB to arrive
+    uint32_t last_position = UINT32_MAX;
+    bool preempted = false; // If the last pcb to run came off the cpu unfinished, only kept with a trace
+    uint64_t context_switches = 0;
+    bool charge = hooks && schedule_cost_enabled(&hooks->cost);
+    uint64_t *stopped = schedule_stop_times(keys, count); // When each pcb last came off the cpu, only kept with a cost model
+    uint64_t overhead_time = 0;
+    uint64_t total_turnaround_time = 0;
+    uint64_t total_waiting_time = 0;
+    uint64_t total_response_time = 0;
+    if (hooks && hooks->trace)
     {
-        // Find the shortest arrival time among all PCBs
-        const ProcessControlBlock_t *first_pcb = (const ProcessControlBlock_t *)dyn_array_at(ready_queue, 0); // *Won't return NULL because loop guard states there is at leats 1 element in the queue
-        uint32_t shortest_burst_time = first_pcb->remaining_burst_time;
-        uint32_t shortest_arrival_time = first_pcb->arrival;
+        note_event(hooks->trace, SCHEDULE_EVENT_ARRIVE, &keys[0], keys[0].arrival);
+    }
+    while (queued > 0 || next < count)
+    {
+        if (queued == 0)
+        {
+            // The last process finished before the next one arrived, fast forward and admit everything there by then
+            if (time < keys[next].arrival)
+            {
+                time = keys[next].arrival;
+            }
+            for (; next < count && keys[next].arrival <= time; next++)
+            {
+                if (hooks && hooks->trace)
+                {
+                    note_event(hooks->trace, SCHEDULE_EVENT_ARRIVE, &keys[next], keys[next].arrival);
+                }
+                remaining[next] = keys[next].burst;
+                ring[(head + queued++) % count] = (uint32_t)next;
+                SCHEDULE_STAT_MOVE(sizeof(uint32_t));
+            }
+        }
 
-        // Move total_run_time forward by the shortest arrival time
-        total_run_time = (shortest_arrival_time > total_run_time) ? shortest_arrival_time : total_run_time;
+        // Take the next pcb in line
+        uint32_t position = ring[head];
+        head = head + 1 == count ? 0 : head + 1;
+        queued--;
 
-        // Find the shortest remaining process by looking at arrival time and burst time
-        size_t pcb_index = 0;
-        for (size_t i = 0; i < dyn_array_size(ready_queue); ++i)
+        // It's getting the cpu for the first time if none of its burst is used up, counted without branching
+        bool first_run = remaining[position] == keys[position].burst;
+        if (hooks && hooks->trace && position != last_position && preempted)
         {
-            const ProcessControlBlock_t *pcb = (const ProcessControlBlock_t *)dyn_array_at(ready_queue, i); // *Won't return NULL because loop stays within bounds of array
+            note_event(hooks->trace, SCHEDULE_EVENT_PREEMPT, &keys[last_position], time);
+        }
+        if (charge && position != last_position && last_position != UINT32_MAX)
+        {
+            stopped[last_position] = time;
+            uint64_t overhead = dispatch_cost(&hooks->cost, first_run ? SCHEDULE_NEVER_RAN : time - stopped[position]);
+            time += overhead;
+            overhead_time += overhead;
+        }
+        if (hooks && hooks->trace && position != last_position)
+        {
+            note_event(hooks->trace, SCHEDULE_EVENT_DISPATCH, &keys[position], time);
+        }
+        total_response_time += first_run * (time - keys[position].arrival);
+        context_switches += position != last_position;
+        last_position = position;
+        if (hooks && hooks->metrics && first_run)
+        {
+            note_first_run(hooks->metrics, &keys[position], time);
+        }
 
-            // If the pcb has arrived
-            if (pcb->arrival <= total_run_time)
+        if (remaining[position] <= quantum)
+        {
+            // It finishes within its quantum
+            time += remaining[position];
+            if (hooks && hooks->timeline)
             {
-                // If the pcb has less burst time than the shortest burst time, update the shortest found burst time and the index
-                if(pcb->remaining_burst_time < shortest_burst_time)
+                note_run(hooks->timeline, &keys[position], time - remaining[position], time);
+            }
+            uint64_t turnaround_time = time - keys[position].arrival;
+            total_turnaround_time += turnaround_time;
+            total_waiting_time += turnaround_time - keys[position].burst;
+            if (hooks && hooks->metrics)
+            {
+                note_completion(hooks->metrics, &keys[position], time);
+            }
+            if (hooks && hooks->trace)
+            {
+                note_event(hooks->trace, SCHEDULE_EVENT_COMPLETE, &keys[position], time);
+            }
+            preempted = false;
+        }
+        else
+        {
+            // Run it for the quantum, queue up everything that arrived meanwhile and then put it back at the end of the line
+            time += quantum;
+            remaining[position] -= quantum;
+            if (hooks && hooks->timeline)
+            {
+                note_run(hooks->timeline, &keys[position], time - quantum, time);
+            }
+            for (; next < count && keys[next].arrival <= time; next++)
+            {
+                if (hooks && hooks->trace)
                 {
-                    shortest_burst_time = pcb->remaining_burst_time;
-                    pcb_index = i;
+                    note_event(hooks->trace, SCHEDULE_EVENT_ARRIVE, &keys[next], keys[next].arrival);
                 }
-            } else {
-                break; // The current pcb and those after it have not arrived and don't need to be considered
+                remaining[next] = keys[next].burst;
+                ring[(head + queued++) % count] = (uint32_t)next;
+                SCHEDULE_STAT_MOVE(sizeof(uint32_t));
             }
+            ring[(head + queued++) % count] = position;
+            SCHEDULE_STAT_MOVE(sizeof(uint32_t));
+            preempted = true;
         }
+    }
+    // The first dispatch isn't a switch
+    write_view_result(result, total_turnaround_time, total_waiting_time, total_response_time, context_switches - 1, overhead_time, time, count);
+}
+
+bool round_robin_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, size_t quantum, ScheduleContext_t *context)
+{
+    schedule_key_t *keys = schedule_view_keys(pcbs, count, result, context);
+    if (keys == NULL || quantum == 0)
+    {
+        return false;
+    }
+    note_phase(context, SCHEDULE_PHASE_SORT);
+    sort_schedule_keys(pcbs, count, keys, compare_key_arrival);
+    note_phase(context, SCHEDULE_PHASE_RUN);
+    if (schedule_hooks_enabled(context))
+    {
+        round_robin_run(keys, count, result, quantum, context);
+    }
+    else
+    {
+        round_robin_run(keys, count, result, quantum, NULL);
+    }
+    note_phase(context, SCHEDULE_PHASE_DONE);
+    SCHEDULE_STAT_FLUSH();
+    return true;
+}
 
-        // Get the PCB with the shortest remaining burst time
-        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, pcb_index); // *Won't return NULL because pcb_index is always set to a valid index within the previous loop
+// SRTF ready queue order, least remaining time first and then the most recent arrival (a new arrival with the same
+// remaining time as the running process preempts it)
+static inline bool srtf_before(const srtf_entry_t *a, const srtf_entry_t *b)
+{
+    return a->remaining != b->remaining ? a->remaining < b->remaining : a->sequence > b->sequence;
+}
+
+SCHEDULE_ALWAYS_INLINE void shortest_remaining_time_first_run(const schedule_key_t *keys, size_t count, ScheduleResult_t *result, const ScheduleContext_t *hooks)
+{
+    // Binary min heap of the arrived PCBs, the running process is always the root
+    srtf_entry_t *heap = (srtf_entry_t *)(keys + count);
+    size_t heap_size = 0;
+    uint32_t sequence = 0;
+    size_t next = 0; // Next PCB to arrive
+    uint32_t last_position = UINT32_MAX;
+    bool preempted = false; // If the last pcb to run came off the cpu unfinished, only kept with a trace
+    uint64_t context_switches = 0;
+    bool charge = hooks && schedule_cost_enabled(&hooks->cost);
+    uint64_t *stopped = schedule_stop_times(keys, count); // When each pcb last came off the cpu, only kept with a cost model
+    uint64_t overhead_time = 0;
+    uint64_t time = 0;
+    uint64_t total_turnaround_time = 0;
+    uint64_t total_waiting_time = 0;
+    uint64_t total_response_time = 0;
+    while (heap_size > 0 || next < count)
+    {
+        // If nothing is waiting, fast forward to the next arrival
+        if (heap_size == 0 && time < keys[next].arrival)
+        {
+            time = keys[next].arrival;
+        }
+        // Admit everything that has arrived, time stops at every arrival so without switch overhead they all arrive now
+        for (; next < count && keys[next].arrival <= time; next++)
+        {
+            if (hooks && hooks->trace)
+            {
+                note_event(hooks->trace, SCHEDULE_EVENT_ARRIVE, &keys[next], keys[next].arrival);
+            }
+            srtf_entry_t entry = {keys[next].burst, sequence++, (uint32_t)next};
+            size_t child = heap_size++;
+            while (child > 0 && srtf_before(&entry, &heap[(child - 1) / 2]))
+            {
+                heap[child] = heap[(child - 1) / 2];
+                SCHEDULE_STAT_MOVE(sizeof(srtf_entry_t));
+                child = (child - 1) / 2;
+            }
+            heap[child] = entry;
+            SCHEDULE_STAT_MOVE(sizeof(srtf_entry_t));
+        }
 
-        // Mark PCB as started
-        pcb->started = true;
+        // Run the process with the least remaining time until it finishes or the next process arrives. Its remaining
+        // time only shrinks so it stays at the root.
+        srtf_entry_t *running = &heap[0];
+        const schedule_key_t *key = &keys[running->position];
+        // It's getting the cpu for the first time if none of its burst is used up, and keeping it if it was the last
+        // to run, both counted without branching
+        bool first_run = running->remaining == key->burst;
+        size_t upcoming = next; // Next arrival that can preempt it
+        if (hooks && hooks->trace && running->position != last_position && preempted)
+        {
+            note_event(hooks->trace, SCHEDULE_EVENT_PREEMPT, &keys[last_position], time);
+        }
+        if (charge && running->position != last_position && last_position != UINT32_MAX)
+        {
+            stopped[last_position] = time;
+            uint64_t overhead = dispatch_cost(&hooks->cost, first_run ? SCHEDULE_NEVER_RAN : time - stopped[running->position]);
+            time += overhead;
+            overhead_time += overhead;
+            // Arrivals during the switch wait for the next decision rather than preempting a pcb that hasn't run yet
+            while (upcoming < count && keys[upcoming].arrival <= time)
+            {
+                upcoming++;
+            }
+        }
+        if (hooks && hooks->trace && running->position != last_position)
+        {
+            note_event(hooks->trace, SCHEDULE_EVENT_DISPATCH, key, time);
+        }
+        total_response_time += first_run * (time - key->arrival);
+        context_switches += running->position != last_position;
+        last_position = running->position;
+        if (hooks && hooks->metrics && first_run)
+        {
+            note_first_run(hooks->metrics, key, time);
+        }
+        uint64_t run_time = running->remaining;
+        if (upcoming < count && keys[upcoming].arrival - time < run_time)
+        {
+            run_time = keys[upcoming].arrival - time;
+        }
+        time += run_time;
+        running->remaining -= run_time;
+        if (hooks && hooks->timeline)
+        {
+            note_run(hooks->timeline, key, time - run_time, time);
+        }
+        preempted = running->remaining > 0;
+        if (preempted)
+        {
+            continue; // Not finished, the arrivals at the new time are admitted next and may preempt it
+        }
 
-        // Update statistics
-        total_run_time += pcb->remaining_burst_time;
-        float turnaround_time = total_run_time - pcb->arrival;
+        uint64_t turnaround_time = time - key->arrival;
         total_turnaround_time += turnaround_time;
-        total_waiting_time += turnaround_time - pcb->remaining_burst_time;
+        total_waiting_time += turnaround_time - key->burst;
+        if (hooks && hooks->metrics)
+        {
+            note_completion(hooks->metrics, key, time);
+        }
+        if (hooks && hooks->trace)
+        {
+            note_event(hooks->trace, SCHEDULE_EVENT_COMPLETE, key, time);
+        }
 
-        // Execute the process
-        virtual_cpu(pcb, pcb->remaining_burst_time);
+        // Pop it by sifting the last entry down from the root
+        srtf_entry_t last = heap[--heap_size];
+        size_t parent = 0;
+        for (size_t child = 1; child < heap_size; child = 2 * parent + 1)
+        {
+            if (child + 1 < heap_size && srtf_before(&heap[child + 1], &heap[child]))
+            {
+                child++;
+            }
+            if (!srtf_before(&heap[child], &last))
+            {
+                break;
+            }
+            heap[parent] = heap[child];
+            SCHEDULE_STAT_MOVE(sizeof(srtf_entry_t));
+            parent = child;
+        }
+        heap[parent] = last;
+        SCHEDULE_STAT_MOVE(sizeof(srtf_entry_t));
+    }
+    // The first dispatch isn't a switch
+    write_view_result(result, total_turnaround_time, total_waiting_time, total_response_time, context_switches - 1, overhead_time, time, count);
+}
 
-        // Mark PCB as completed
-        pcb->completed = true;
+bool shortest_remaining_time_first_view(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, ScheduleContext_t *context)
+{
+    schedule_key_t *keys = schedule_view_keys(pcbs, count, result, context);
+    if (keys == NULL)
+    {
+        return false;
+    }
+    note_phase(context, SCHEDULE_PHASE_SORT);
+    sort_schedule_keys(pcbs, count, keys, compare_key_arrival_burst);
+    note_phase(context, SCHEDULE_PHASE_RUN);
+    if (schedule_hooks_enabled(context))
+    {
+        shortest_remaining_time_first_run(keys, count, result, context);
+    }
+    else
+    {
+        shortest_remaining_time_first_run(keys, count, result, NULL);
+    }
+    note_phase(context, SCHEDULE_PHASE_DONE);
+    SCHEDULE_STAT_FLUSH();
+    return true;
+}
 
-        // Remove the processed PCB from the ready_queue
-        dyn_array_erase(ready_queue, pcb_index);
+// Private function that runs one of the view schedulers over a dyn_array's PCBs with scratch from the heap, leaving the dyn_array untouched
+static bool schedule_dyn_array(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum,
+                               bool (*scheduler)(const ProcessControlBlock_t *, size_t, ScheduleResult_t *, size_t, ScheduleContext_t *))
+{
+    if (ready_queue == NULL || result == NULL || dyn_array_size(ready_queue) == 0)
+    {
+        return false;
+    }
+    size_t count = dyn_array_size(ready_queue);
+    size_t scratch_size = schedule_scratch_size(count);
+    void *scratch = malloc(scratch_size);
+    if (scratch == NULL)
+    {
+        return false;
     }
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    bool success = scheduler((const ProcessControlBlock_t *)dyn_array_export(ready_queue), count, result, quantum, &context);
+    free(scratch);
+    return success;
+}
 
-    // Update the result structure with calculated averages
-    write_schedule_result(result, total_turnaround_time, total_waiting_time, total_run_time, starting_queue_size);
+// Adapters giving the view schedulers that don't take a quantum the same signature as round_robin_view
+static bool first_come_first_serve_adapter(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, size_t quantum, ScheduleContext_t *context)
+{
+    (void)quantum; // Only round robin uses the quantum
+    return first_come_first_serve_view(pcbs, count, result, context);
+}
 
-    return true;
+static bool shortest_job_first_adapter(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, size_t quantum, ScheduleContext_t *context)
+{
+    (void)quantum; // Only round robin uses the quantum
+    return shortest_job_first_view(pcbs, count, result, context);
+}
+
+static bool shortest_remaining_time_first_adapter(const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, size_t quantum, ScheduleContext_t *context)
+{
+    (void)quantum; // Only round robin uses the quantum
+    return shortest_remaining_time_first_view(pcbs, count, result, context);
+}
+
+bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    return schedule_dyn_array(ready_queue, result, 0, first_come_first_serve_adapter);
+}
+
+bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    return schedule_dyn_array(ready_queue, result, 0, shortest_job_first_adapter);
 }
 
 // bool priority(dyn_array_t *ready_queue, ScheduleResult_t *result)
@@ -148,244 +844,573 @@ bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
 
 bool round_robin(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum)
 {
-    // Error checking
-    if (ready_queue == NULL || result == NULL || dyn_array_size(ready_queue) == 0 || quantum == 0)
-        return false;
-
-    // Initialize variables for tracking statistics
-    float total_waiting_time = 0.0;
-    float total_turnaround_time = 0.0;
-    unsigned long total_run_time = 0;
-    int starting_queue_size = dyn_array_size(ready_queue);
+    return schedule_dyn_array(ready_queue, result, quantum, round_robin_view);
+}
 
-    // Sort queue based on arrival time
-    dyn_array_sort(ready_queue, compare_arrival);
+bool shortest_remaining_time_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    return schedule_dyn_array(ready_queue, result, 0, shortest_remaining_time_first_adapter);
+}
 
-    // Initialize array for the arrived processes
-    dyn_array_t *arrived_processes = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL); 
-    if(arrived_processes == NULL)
+bool pcb_file_layout(const void *header, size_t header_size, uint64_t file_size, PcbFileLayout_t *layout)
+{
+    if (header == NULL || layout == NULL)
     {
         return false;
     }
+    // A file in the original layout starts with the magic when its count reads "PCB6", about 9.1e8 pcbs or 10.9 GB of
+    // them. The two layouts can't both fit the same size (4 + 12n = 16 + 24m has no whole solution), so the magic only
+    // counts when the size matches the PCB64 count exactly.
+    if (header_size >= PCB64_MAGIC_SIZE + sizeof(uint64_t) && memcmp(header, PCB64_MAGIC, PCB64_MAGIC_SIZE) == 0)
+    {
+        uint64_t pcb_count;
+        memcpy(&pcb_count, (const uint8_t *)header + PCB64_MAGIC_SIZE, sizeof(uint64_t));
+        uint64_t record_bytes = file_size - (PCB64_MAGIC_SIZE + sizeof(uint64_t));
+        if (file_size >= PCB64_MAGIC_SIZE + sizeof(uint64_t) && record_bytes % (3 * sizeof(uint64_t)) == 0 &&
+            record_bytes / (3 * sizeof(uint64_t)) == pcb_count)
+        {
+            layout->pcb_count = pcb_count;
+            layout->header_size = PCB64_MAGIC_SIZE + sizeof(uint64_t);
+            layout->field_size = sizeof(uint64_t);
+            return true;
+        }
+    }
+    if (header_size < sizeof(uint32_t))
+    {
+        return false; // Not even a count
+    }
+    uint32_t pcb_count;
+    memcpy(&pcb_count, header, sizeof(uint32_t));
+    layout->pcb_count = pcb_count;
+    layout->header_size = sizeof(uint32_t);
+    layout->field_size = sizeof(uint32_t);
+    return true;
+}
 
-    // Initialize the arrived processes array to hold the first processes
-    ProcessControlBlock_t *first_pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, 0); // *Won't return NULL because the ready_queue size was already checked and handled if 0
-    bool success = dyn_array_push_back(arrived_processes, first_pcb);
-
-    // If an error occured, delete the arrived_processes array and return false
-    if(!success)
+bool decode_pcb_records(const void *records, size_t count, size_t field_size, ProcessControlBlock_t *pcbs)
+{
+    if (field_size == sizeof(uint32_t))
     {
-        dyn_array_destroy(arrived_processes);
-        return false;
+        const uint32_t *record = (const uint32_t *)records; // burst, priority, arrival
+        for (size_t i = 0; i < count; i++, record += 3)
+        {
+            create_pcb(record[2], record[1], record[0], false, &pcbs[i]);
+        }
+        return true;
+    }
+    const uint64_t *record = (const uint64_t *)records; // burst, priority, arrival
+    for (size_t i = 0; i < count; i++, record += 3)
+    {
+        if (record[1] > UINT32_MAX)
+        {
+            return false; // Priorities are 32 bit in both layouts
+        }
+        create_pcb(record[2], (uint32_t)record[1], record[0], false, &pcbs[i]);
     }
-    total_run_time = first_pcb->arrival;
-    success = dyn_array_erase(ready_queue, 0);
+    return true;
+}
 
-    // If an error occured, delete the arrived_processes array and return false
-    if(!success)
+dyn_array_t *load_process_control_blocks(const char *input_file)
+{
+    if (input_file == NULL)
     {
-        dyn_array_destroy(arrived_processes);
-        return false;
+        return NULL; // Return NULL if input_file is NULL (no file to read)
+    }
+    FILE *fp = fopen(input_file, "r"); // Open the file in read mode
+    if (!fp)
+    {
+        return NULL; // Return NULL if the file wasn't able to be opened
     }
-    
-    // Process each PCB in the ready queue until all are removed
-    while (dyn_array_size(arrived_processes) > 0) 
+    uint8_t header[PCB_FILE_HEADER_MAX];                                  // The start of the file, enough to tell the layouts apart
+    size_t header_read = fread(header, 1, PCB_FILE_HEADER_MAX, fp);       // A small file may be shorter than the longest header
+    struct stat file_stat;                                                // The size tells a PCB64 file from an original one
+    PcbFileLayout_t layout;                                               // Where the count and records are, and how wide the fields are
+    if (fstat(fileno(fp), &file_stat) != 0 || !pcb_file_layout(header, header_read, (uint64_t)file_stat.st_size, &layout) ||
+        layout.pcb_count > SIZE_MAX / sizeof(ProcessControlBlock_t) || fseek(fp, (long)layout.header_size, SEEK_SET) != 0)
     {
-        // Get the next pcb in line
-        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(arrived_processes, 0); // *Won't return NULL because of loop guard stating there is at least 1 element in the queue
+        fclose(fp);
+        return NULL; // Return NULL if there is no count or it can't possibly fit in memory
+    }
+    size_t pcb_count = (size_t)layout.pcb_count;
+    ProcessControlBlock_t *pcb_array = malloc(sizeof(ProcessControlBlock_t) * pcb_count); // Allocate space for an array that can hold 'pcb_count' pcbs
+    if (!pcb_array)
+    {
+        fclose(fp);
+        return NULL; // Return NULL if memory couldn't be allocated
+    }
+    uint64_t record[3]; // Big enough for a record of either layout
+    for (size_t i = 0; i < pcb_count; i++) // Iterate through pcb_count
+    {
+        // Read the burst time, priority and arrival of the next pcb and initialize the pcb with them
+        if (fread(record, layout.field_size, 3, fp) != 3 || !decode_pcb_records(record, 1, layout.field_size, &pcb_array[i]))
+        {
+            fclose(fp);
+            free(pcb_array); // Free the pcb_array since the file is short or holds an invalid record
+            return NULL;
+        }
+    }
+    fclose(fp);                                                                                           // Close the file
+    dyn_array_t *dyn_array = dyn_array_import(pcb_array, pcb_count, sizeof(ProcessControlBlock_t), NULL); // Create a dyn_array out of the pcb_array
+    free(pcb_array);                                                                                      // Free the pcb_array
+    return dyn_array;                                                                                     // Return the dyn_array
+}
 
-        // Mark PCB as started
-        if(!pcb->started){
-            pcb->started = true;
+#define PARALLEL_LOAD_CHUNK_RECORDS (1 << 16)    // Number of records a loader thread reads with each pread
+#define PARALLEL_LOAD_MIN_RECORDS (1 << 14)      // Files smaller than this (in records) aren't worth splitting between threads
+
+// Work given to each loader thread, a disjoint range of records in the file and the destination pcbs
+typedef struct
+{
+    int fd;
+    const PcbFileLayout_t *layout;
+    size_t first_record;
+    size_t record_count;
+    ProcessControlBlock_t *destination;
+    bool success;
+} pcb_load_range_t;
+
+// Decodes one range of the binary pcb file into its slice of the destination array
+static void *load_pcb_range(void *arg)
+{
+    pcb_load_range_t *range = (pcb_load_range_t *)arg;
+    range->success = false;
+    size_t chunk_records = range->record_count < PARALLEL_LOAD_CHUNK_RECORDS ? range->record_count : PARALLEL_LOAD_CHUNK_RECORDS;
+    size_t record_size = 3 * range->layout->field_size; // burst, priority, arrival
+    void *buffer = malloc(chunk_records * record_size);
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    size_t done = 0;
+    while (done < range->record_count)
+    {
+        size_t records = range->record_count - done < chunk_records ? range->record_count - done : chunk_records;
+        size_t bytes = records * record_size;
+        off_t offset = (off_t)(range->layout->header_size + (range->first_record + done) * record_size);
+        size_t bytes_read = 0;
+        while (bytes_read < bytes) // pread may return less than asked for, keep going until the chunk is full
+        {
+            ssize_t result = pread(range->fd, (uint8_t *)buffer + bytes_read, bytes - bytes_read, offset + (off_t)bytes_read);
+            if (result <= 0)
+            {
+                free(buffer); // The file is shorter than its count says (or couldn't be read)
+                return NULL;
+            }
+            bytes_read += (size_t)result;
         }
-        
-        // Depending on whether the process will be executed in its entirety...
-        if (pcb->remaining_burst_time <= quantum)
+        if (!decode_pcb_records(buffer, records, range->layout->field_size, &range->destination[done]))
         {
-           
-            // Update statistics
-            total_run_time += pcb->remaining_burst_time;
-            float turnaround_time = total_run_time - pcb->arrival;
-            total_turnaround_time += turnaround_time;
-            total_waiting_time += turnaround_time - pcb->total_burst_time;
+            free(buffer);
+            return NULL;
+        }
+        done += records;
+    }
+    free(buffer);
+    range->success = true;
+    return NULL;
+}
 
-            // Execute the process
-            virtual_cpu(pcb, pcb->remaining_burst_time);
+dyn_array_t *load_process_control_blocks_parallel(const char *input_file, size_t thread_count)
+{
+    if (input_file == NULL)
+    {
+        return NULL;
+    }
+    int fd = open(input_file, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    uint8_t header[PCB_FILE_HEADER_MAX];
+    ssize_t header_read = pread(fd, header, PCB_FILE_HEADER_MAX, 0);
+    PcbFileLayout_t layout;
+    struct stat file_stat;
+    // Same validation as load_process_control_blocks, the count must be present and the file must hold at least 'count' records
+    if (header_read < 0 || fstat(fd, &file_stat) != 0 || !pcb_file_layout(header, (size_t)header_read, (uint64_t)file_stat.st_size, &layout) ||
+        layout.pcb_count == 0 || layout.pcb_count > SIZE_MAX / sizeof(ProcessControlBlock_t) ||
+        (uint64_t)file_stat.st_size < layout.header_size + layout.pcb_count * 3 * layout.field_size)
+    {
+        close(fd);
+        return NULL;
+    }
+    size_t pcb_count = (size_t)layout.pcb_count;
+    dyn_array_t *dyn_array = dyn_array_create(pcb_count, sizeof(ProcessControlBlock_t), NULL);
+    if (dyn_array == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
 
-            // Mark PCB as completed
-            pcb->completed = true;
+    if (thread_count == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN); // Default to one thread per cpu
+        thread_count = online > 0 ? (size_t)online : 1;
+    }
+    size_t max_threads = (pcb_count + PARALLEL_LOAD_MIN_RECORDS - 1) / PARALLEL_LOAD_MIN_RECORDS;
+    if (thread_count > max_threads)
+    {
+        thread_count = max_threads; // Don't start threads for tiny slices
+    }
 
-            // Remove the processed PCB from the ready_queue
-            dyn_array_erase(arrived_processes, 0);
+    pcb_load_range_t *ranges = malloc(sizeof(pcb_load_range_t) * thread_count);
+    pthread_t *threads = malloc(sizeof(pthread_t) * thread_count);
+    bool success = ranges != NULL && threads != NULL;
+    size_t started = 0;
+    for (size_t i = 0; success && i < thread_count; i++)
+    {
+        // Split the records as evenly as possible, the first 'pcb_count % thread_count' ranges get one extra record
+        size_t base = pcb_count / thread_count;
+        size_t extra = pcb_count % thread_count;
+        size_t first = i * base + (i < extra ? i : extra);
+        ranges[i] = (pcb_load_range_t){fd, &layout, first, base + (i < extra ? 1 : 0), (ProcessControlBlock_t *)dyn_array->array + first, false};
+        if (i == 0)
+        {
+            continue; // The first range is decoded on the calling thread once the others are running
         }
-        else
+        if (pthread_create(&threads[i], NULL, load_pcb_range, &ranges[i]) != 0)
         {
-            // Update statistics
-            total_run_time += quantum;
+            success = false;
+            break;
+        }
+        started = i;
+    }
+    if (success)
+    {
+        load_pcb_range(&ranges[0]);
+        success = ranges[0].success;
+    }
+    for (size_t i = 1; i <= started; i++)
+    {
+        pthread_join(threads[i], NULL);
+        success = success && ranges[i].success;
+    }
+    free(threads);
+    free(ranges);
+    close(fd);
 
-            // Execute the process for the quantum amount
-            virtual_cpu(pcb, quantum);
+    if (!success)
+    {
+        dyn_array_destroy(dyn_array);
+        return NULL;
+    }
+    dyn_array->size = pcb_count; // The records were decoded straight into the array's storage
+    return dyn_array;
+}
+
+#define CSV_READ_BUFFER_SIZE (1 << 20) // Size of the buffer the csv file is read into (1 MiB)
+
+// Parses an unsigned integer no bigger than 'max' starting at *cursor and moves *cursor past it, returns false on an empty or overflowing field
+static bool parse_csv_uint(const char **cursor, const char *end, uint64_t max, uint64_t *value)
+{
+    const char *c = *cursor;
+    while (c < end && (*c == ' ' || *c == '\r'))
+    {
+        c++; // Skip leading whitespace, but not tabs, or an empty field of a tsv line would take the next one's value
+    }
+    const char *digits = c;
+    uint64_t result = 0;
+    while (c < end && *c >= '0' && *c <= '9')
+    {
+        uint64_t digit = (uint64_t)(*c - '0');
+        if (result > (max - digit) / 10)
+        {
+            return false; // The value doesn't fit into the field
+        }
+        result = result * 10 + digit;
+        c++;
+    }
+    if (c == digits)
+    {
+        return false; // No digits were found
+    }
+    while (c < end && (*c == ' ' || *c == '\r'))
+    {
+        c++; // Skip trailing whitespace
+    }
+    *value = result;
+    *cursor = c;
+    return true;
+}
 
-            // While there are still processes in the ready queue
-            while(dyn_array_size(ready_queue) > 0)
+// Parses a single csv line (arrival, burst, priority) that does not contain the newline, returns false if the line is malformed
+static bool parse_csv_line(const char *line, const char *end, uint64_t *arrival, uint64_t *burst, uint32_t *priority)
+{
+    uint64_t priority_value = 0;
+    uint64_t *fields[] = {arrival, burst, &priority_value};
+    uint64_t limits[] = {UINT64_MAX, UINT64_MAX, UINT32_MAX}; // Times are 64 bit, priorities 32 bit
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (i > 0)
+        {
+            if (line == end || (*line != ',' && *line != '\t'))
             {
-                // Get the first process
-                ProcessControlBlock_t *front_pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, 0); // *Won't return NULL because of loop guard stating there is at least 1 element in the queue
+                return false; // Missing separator between fields
+            }
+            line++;
+        }
+        if (!parse_csv_uint(&line, end, limits[i], fields[i]))
+        {
+            return false;
+        }
+    }
+    *priority = (uint32_t)priority_value;
+    return line == end; // Trailing garbage makes the line invalid
+}
 
-                // If there are no processes in the arrived queue and the front process hasn't "arrived" yet, fast forward to the arrival time
-                if(dyn_array_size(arrived_processes) == 0 && total_run_time < front_pcb->arrival){
-                    total_run_time = front_pcb->arrival;
+// Reads every record of the csv file and hands it to 'emit', stopping at the first malformed line
+static bool parse_pcb_csv(FILE *fp, size_t *error_line, bool (*emit)(void *arg, uint64_t arrival, uint64_t burst, uint32_t priority), void *arg)
+{
+    char *buffer = malloc(CSV_READ_BUFFER_SIZE);
+    if (buffer == NULL)
+    {
+        return false;
+    }
+    size_t line_number = 0;   // Number of the line currently being parsed
+    size_t buffered = 0;      // Bytes currently held in the buffer
+    bool seen_record = false; // Whether a data (or header) line has been seen yet
+    bool at_eof = false;
+    bool success = true;
+
+    while (success && (!at_eof || buffered > 0))
+    {
+        if (!at_eof)
+        {
+            size_t bytes_read = fread(buffer + buffered, 1, CSV_READ_BUFFER_SIZE - buffered, fp); // Top up the buffer behind the carried over partial line
+            buffered += bytes_read;
+            if (bytes_read == 0)
+            {
+                if (ferror(fp))
+                {
+                    success = false;
+                    break;
                 }
+                at_eof = true;
+            }
+        }
+
+        const char *cursor = buffer;
+        const char *buffer_end = buffer + buffered;
+        while (cursor < buffer_end)
+        {
+            const char *newline = memchr(cursor, '\n', buffer_end - cursor);
+            if (newline == NULL && !at_eof)
+            {
+                break; // Partial line, read more of the file before parsing it
+            }
+            const char *line_end = newline ? newline : buffer_end;
+            line_number++;
 
-                // If the pcb has arrived, add it to the queue and remove it from the ready queue
-                if(front_pcb->arrival <= total_run_time)
+            const char *first = cursor;
+            while (first < line_end && (*first == ' ' || *first == '\t' || *first == '\r'))
+            {
+                first++;
+            }
+            if (first != line_end && *first != '#') // Blank lines and comments are skipped
+            {
+                uint64_t arrival, burst;
+                uint32_t priority;
+                if (parse_csv_line(cursor, line_end, &arrival, &burst, &priority))
                 {
-                    success = dyn_array_push_back(arrived_processes, front_pcb);
-                    // If an error occured, delete the arrived_processes array and return false
-                    if(!success)
+                    if (!emit(arg, arrival, burst, priority))
                     {
-                        dyn_array_destroy(arrived_processes);
-                        return false;
+                        success = false;
+                        break;
                     }
-                    success = dyn_array_erase(ready_queue, 0);
-                    // If an error occured, delete the arrived_processes array and return false
-                    if(!success)
-                    {
-                        dyn_array_destroy(arrived_processes);
-                        return false;
-                    }
-                } else {
-                    // No pcbs are ready yet
+                }
+                else if (seen_record || (*first >= '0' && *first <= '9'))
+                {
+                    success = false; // Only the first line may be a (non numeric) header
                     break;
                 }
+                seen_record = true;
             }
+            cursor = newline ? newline + 1 : buffer_end;
+        }
 
-            // Move PCB to the end of the queue, but DONT erase it
-            success = dyn_array_push_back(arrived_processes, pcb);
-            // If an error occured, delete the arrived_processes array and return false
-            if(!success)
-            {
-                dyn_array_destroy(arrived_processes);
-                return false;
-            }
-            success = dyn_array_erase(arrived_processes, 0);
-            // If an error occured, delete the arrived_processes array and return false
-            if(!success)
+        if (success)
+        {
+            buffered = buffer_end - cursor;
+            if (buffered == CSV_READ_BUFFER_SIZE)
             {
-                dyn_array_destroy(arrived_processes);
-                return false;
+                line_number++;
+                success = false; // A single line doesn't fit in the buffer so the file can't be valid
+                break;
             }
+            memmove(buffer, cursor, buffered); // Carry the partial line over to the start of the buffer
         }
     }
 
-    // Update the result structure with calculated averages
-    write_schedule_result(result, total_turnaround_time, total_waiting_time, total_run_time, starting_queue_size);
+    free(buffer);
+    if (!success && error_line != NULL)
+    {
+        *error_line = line_number;
+    }
+    return success;
+}
 
-    return true;
+// Appends a parsed csv record to the dyn_array passed as arg
+static bool emit_csv_pcb(void *arg, uint64_t arrival, uint64_t burst, uint32_t priority)
+{
+    ProcessControlBlock_t pcb;
+    create_pcb(arrival, priority, burst, false, &pcb);
+    return dyn_array_push_back((dyn_array_t *)arg, &pcb);
 }
 
-dyn_array_t *load_process_control_blocks(const char *input_file)
+dyn_array_t *load_process_control_blocks_csv(const char *input_file, size_t *error_line)
 {
+    if (error_line != NULL)
+    {
+        *error_line = 0;
+    }
     if (input_file == NULL)
     {
-        return NULL; // Return NULL if input_file is NULL (no file to read)
+        return NULL;
     }
-    FILE *fp = fopen(input_file, "r"); // Open the file in read mode
+    FILE *fp = fopen(input_file, "r");
     if (!fp)
     {
-        return NULL; // Return NULL if the file wasn't able to be opened
+        return NULL;
     }
-    uint32_t pcb_count;                                         // Variable for storing the pcb_count in the file (the first line in the file)
-    size_t elements_read;                                       // Variable for storing the number of elements read when using fread
-    elements_read = fread(&pcb_count, sizeof(uint32_t), 1, fp); // Read the first line and store the contents in pcb_content
-    if (elements_read != 1)
+    dyn_array_t *dyn_array = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    if (dyn_array == NULL)
     {
-        fclose(fp); 
-        return NULL; // Return NULL if less than 1 or more than 1 elements were read
+        fclose(fp);
+        return NULL;
     }
-    ProcessControlBlock_t *pcb_array = malloc(sizeof(ProcessControlBlock_t) * pcb_count); // Allocate space for an array that can hold 'pcb_count' pcbs
-    if (!pcb_array)
+    bool success = parse_pcb_csv(fp, error_line, emit_csv_pcb, dyn_array);
+    fclose(fp);
+    if (!success || dyn_array_size(dyn_array) == 0)
     {
-        fclose(fp); 
-        return NULL; // Return NULL if memory couldn't be allocated
+        dyn_array_destroy(dyn_array); // Match the binary loader, an empty file is not a valid pcb file
+        return NULL;
     }
-    for (uint32_t i = 0; i < pcb_count; i++) // Iterate through pcb_count
+    return dyn_array;
+}
+
+#define CSV_TRANSCODE_BATCH 4096 // Number of records batched up before they are written to the binary file
+
+// State for writing csv records straight to a binary pcb file
+typedef struct
+{
+    FILE *output;
+    uint64_t count;
+    bool wide;       // Writing the PCB64 layout rather than the original one
+    bool needs_wide; // Set when a record doesn't fit the original layout
+    size_t batched;  // Number of records waiting in 'records'
+    union
     {
-        ProcessControlBlock_t *pcb = &(pcb_array[i]);                                 // Get the current pcb to read values for
-        uint32_t remaining_burst_time;                                                //Stores the remaining burst time
-        uint32_t priority;                                                            //Stores the priority
-        uint32_t arrival;                                                             //Store the arrival time
-        elements_read = fread(&remaining_burst_time, sizeof(uint32_t), 1, fp); // Read the next line in the file (which corresponds to the burst time) and update the pcb's burst time
-        if (elements_read != 1)
-        {
-            fclose(fp); 
-            free(pcb_array); // Free the pcb_array since an invalid number of elements were read (most likely 0 or an error) meaning the file is invalid
-            return NULL;     // Return NULL if less than 1 or more than 1 elements were read
-        }
-        elements_read = fread(&priority, sizeof(uint32_t), 1, fp); // Read the next line in the file (which corresponds to the priority) and update the pcb's priority
-        if (elements_read != 1)
-        {
-            fclose(fp); 
-            free(pcb_array); // Free the pcb_array since an invalid number of elements were read (most likely 0 or an error) meaning the file is invalid
-            return NULL;     // Return NULL if less than 1 or more than 1 elements were read
-        }
-        elements_read = fread(&arrival, sizeof(uint32_t), 1, fp); // Read the next line in the file (which corresponds to the arrival) and update the pcb's arrival
-        if (elements_read != 1)
-        {
-            fclose(fp); 
-            free(pcb_array); // Free the pcb_array since an invalid number of elements were read (most likely 0 or an error) meaning the file is invalid
-            return NULL;     // Return NULL if less than 1 or more than 1 elements were read
-        }
-        create_pcb( arrival,  priority,  remaining_burst_time, false, pcb); //Initialize the pcb with the read values
+        uint32_t narrow[CSV_TRANSCODE_BATCH * 3];
+        uint64_t wide[CSV_TRANSCODE_BATCH * 3];
+    } records; // Records in the burst, priority, arrival layout
+} csv_transcode_state_t;
+
+// Writes the header for the records written so far at the current position of the binary file
+static bool write_binary_pcb_header(csv_transcode_state_t *state)
+{
+    if (state->wide)
+    {
+        return fwrite(PCB64_MAGIC, 1, PCB64_MAGIC_SIZE, state->output) == PCB64_MAGIC_SIZE &&
+               fwrite(&state->count, sizeof(uint64_t), 1, state->output) == 1;
     }
-    fclose(fp);                                                                                           // Close the file
-    dyn_array_t *dyn_array = dyn_array_import(pcb_array, pcb_count, sizeof(ProcessControlBlock_t), NULL); // Create a dyn_array out of the pcb_array
-    free(pcb_array);                                                                                      // Free the pcb_array
-    return dyn_array;                                                                                     // Return the dyn_array
+    uint32_t count = (uint32_t)state->count;
+    return fwrite(&count, sizeof(uint32_t), 1, state->output) == 1;
 }
 
-bool shortest_remaining_time_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
+// Writes out the batched records, returns false if they couldn't all be written
+static bool flush_binary_pcbs(csv_transcode_state_t *state)
 {
-    if (ready_queue == NULL || dyn_array_size(ready_queue) == 0 || result == NULL)
+    size_t values = state->batched * 3;
+    state->batched = 0;
+    if (state->wide)
     {
-        return false; // Return false if ready_queue is NULL or size is 0 (no pcbs to process) or result is NULL (no memory allocated for the result)
+        return fwrite(state->records.wide, sizeof(uint64_t), values, state->output) == values;
     }
-    uint32_t process_count = ready_queue->size; // The number of processes in the queue
-    uint32_t total_turnaround_time = 0;         // The sum of all turnaround times
-    uint32_t total_wait_time = 0;               // The sum of all wait times
-
-    dyn_array_sort(ready_queue, compare_arrival_burst); // sort array by arrival time (if equal then by burst time)
+    return fwrite(state->records.narrow, sizeof(uint32_t), values, state->output) == values;
+}
 
-    dyn_array_t *arrived_processes = dyn_array_create(ready_queue->capacity, sizeof(ProcessControlBlock_t), NULL); // dyn_array fors holding the processes that have arrived
-    if(arrived_processes == NULL)
+// Adds a parsed csv record to the batch destined for the binary file
+static bool emit_binary_pcb(void *arg, uint64_t arrival, uint64_t burst, uint32_t priority)
+{
+    csv_transcode_state_t *state = (csv_transcode_state_t *)arg;
+    if (state->wide)
     {
-        return false; //Return false if arrived_processes array could not be allocated
+        uint64_t *record = &state->records.wide[state->batched * 3];
+        record[0] = burst;
+        record[1] = priority;
+        record[2] = arrival;
     }
-    uint32_t current_wait_time;                                                                                    // The time that has elapsed
-
-    enqueue_processes(ready_queue, arrived_processes, &current_wait_time, compare_burst); // Add processes to the arrived_processes queue that have arrived and sort them by burst time
+    else if (arrival > UINT32_MAX || burst > UINT32_MAX || state->count == UINT32_MAX)
+    {
+        state->needs_wide = true; // The original layout can't hold it, the caller starts over with the PCB64 one
+        return false;
+    }
+    else
+    {
+        uint32_t *record = &state->records.narrow[state->batched * 3];
+        record[0] = (uint32_t)burst;
+        record[1] = priority;
+        record[2] = (uint32_t)arrival;
+    }
+    state->count++;
+    return ++state->batched < CSV_TRANSCODE_BATCH || flush_binary_pcbs(state);
+}
 
-    while (arrived_processes->size) // While there are processes in the arrived_processes queue
+bool transcode_pcb_csv_to_binary(const char *input_file, const char *output_file, size_t *error_line)
+{
+    if (error_line != NULL)
+    {
+        *error_line = 0;
+    }
+    if (input_file == NULL || output_file == NULL)
+    {
+        return false;
+    }
+    FILE *input = fopen(input_file, "r");
+    if (!input)
     {
-        ProcessControlBlock_t *pcb = ((ProcessControlBlock_t *)dyn_array_front(arrived_processes)); // Get the pcb at the front
-        if (!pcb->started)
+        return false;
+    }
+    FILE *output = fopen(output_file, "wb");
+    if (!output)
+    {
+        fclose(input);
+        return false;
+    }
+    csv_transcode_state_t *state = malloc(sizeof(csv_transcode_state_t));
+    bool success = state != NULL;
+    bool wide = false;
+    while (success)
+    {
+        state->output = output;
+        state->count = 0;
+        state->wide = wide;
+        state->needs_wide = false;
+        state->batched = 0;
+        success = write_binary_pcb_header(state); // Reserve room for the header
+        success = success && parse_pcb_csv(input, error_line, emit_binary_pcb, state);
+        success = success && flush_binary_pcbs(state) && state->count > 0;
+        if (success || !state->needs_wide)
         {
-            pcb->started = true; // Set the started property to true if it hasn't already been started
+            break;
         }
-
-        current_wait_time++;                // Increment the elapsed time
-        virtual_cpu(pcb, 1);                // Send pcb to the cpu (decrement burst time)
-        if (pcb->remaining_burst_time == 0) // If the pcb has finished
+        // Most files fit the original layout so it's tried first, start over in the PCB64 one if a record didn't
+        wide = true;
+        if (error_line != NULL)
         {
-            uint32_t turnaround_time = current_wait_time - pcb->arrival; // The turnaround time for the pcb
-            total_turnaround_time += turnaround_time;                    // Add to the total turnaround time
-            total_wait_time += turnaround_time - pcb->total_burst_time;  // Add to the total wait time
-            dyn_array_pop_front(arrived_processes);                      // Remove the pcb from the queue
+            *error_line = 0;
         }
-        enqueue_processes(ready_queue, arrived_processes, &current_wait_time, compare_burst); // Add the processes to the arrived_processes queue that have arrived and sort them by burst time
+        rewind(input);
+        output = freopen(output_file, "wb", output);
+        success = output != NULL;
     }
-    dyn_array_destroy(arrived_processes); // Free the arrived_processes array
-    write_schedule_result(result, total_turnaround_time, total_wait_time, current_wait_time, process_count); //Write the results to the result struct
-
-    return true; // Return true because all processes were successfully completed
-}
\ No newline at end of file
+    // Go back and fill in the real count now that every record has been written
+    success = success && fseek(output, 0, SEEK_SET) == 0 && write_binary_pcb_header(state);
+    free(state);
+    fclose(input);
+    success = output != NULL && fclose(output) == 0 && success;
+    if (!success)
+    {
+        remove(output_file); // Don't leave a half written pcb file behind
+    }
+    return success;
+}
@@ -0,0 +1,151 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "schedule_metrics.h"
+
+uint64_t pcb_metric_value(const PcbMetrics_t *metrics, PcbMetric_t metric)
+{
+    switch (metric)
+    {
+    case PCB_METRIC_WAITING:
+        return metrics->waiting;
+    case PCB_METRIC_TURNAROUND:
+        return metrics->turnaround;
+    case PCB_METRIC_RESPONSE:
+        return metrics->response;
+    default:
+        return 0;
+    }
+}
+
+static inline void swap_values(uint64_t *a, uint64_t *b)
+{
+    uint64_t temporary = *a;
+    *a = *b;
+    *b = temporary;
+}
+
+// Partially orders values[low, high] so values[n] holds what it would in sorted order, with everything before it no
+// larger and everything after it no smaller (std::nth_element)
+static void select_nth(uint64_t *values, ptrdiff_t low, ptrdiff_t high, ptrdiff_t n)
+{
+    while (low < high)
+    {
+        // Median of three pivot, which also leaves sentinels at both ends of the range
+        ptrdiff_t middle = low + (high - low) / 2;
+        if (values[middle] < values[low])
+        {
+            swap_values(&values[middle], &values[low]);
+        }
+        if (values[high] < values[low])
+        {
+            swap_values(&values[high], &values[low]);
+        }
+        if (values[high] < values[middle])
+        {
+            swap_values(&values[high], &values[middle]);
+        }
+        uint64_t pivot = values[middle];
+
+        // Hoare partition, equal values are split between both sides so runs of duplicates stay balanced
+        ptrdiff_t i = low;
+        ptrdiff_t j = high;
+        while (i <= j)
+        {
+            while (values[i] < pivot)
+            {
+                i++;
+            }
+            while (values[j] > pivot)
+            {
+                j--;
+            }
+            if (i <= j)
+            {
+                swap_values(&values[i++], &values[j--]);
+            }
+        }
+        // [low, j] <= pivot, [i, high] >= pivot and anything in between equals the pivot
+        if (n <= j)
+        {
+            high = j;
+        }
+        else if (n >= i)
+        {
+            low = i;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+bool schedule_percentiles(const PcbMetrics_t *metrics, size_t count, PcbMetric_t metric, uint64_t *scratch, SchedulePercentiles_t *percentiles)
+{
+    if (metrics == NULL || count == 0 || metric >= PCB_METRIC_COUNT || percentiles == NULL)
+    {
+        return false;
+    }
+    uint64_t *values = scratch ? scratch : malloc(sizeof(uint64_t) * count);
+    if (values == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = pcb_metric_value(&metrics[i], metric);
+    }
+
+    // Nearest rank percentiles in increasing order (in tenths of a percent), each selection only has to look above the last one
+    const size_t per_mille[] = {500, 900, 990, 999, 1000};
+    uint64_t *outputs[] = {&percentiles->p50, &percentiles->p90, &percentiles->p99, &percentiles->p999, &percentiles->max};
+    size_t low = 0;
+    for (size_t i = 0; i < sizeof(per_mille) / sizeof(per_mille[0]); i++)
+    {
+        size_t rank = (per_mille[i] * count + 999) / 1000;
+        size_t n = rank > 0 ? rank - 1 : 0;
+        select_nth(values, (ptrdiff_t)low, (ptrdiff_t)count - 1, (ptrdiff_t)n);
+        *outputs[i] = values[n];
+        low = n;
+    }
+    if (scratch == NULL)
+    {
+        free(values);
+    }
+    return true;
+}
+
+bool print_schedule_percentiles(const PcbMetrics_t *metrics, size_t count, FILE *file)
+{
+    if (metrics == NULL || count == 0 || file == NULL)
+    {
+        return false;
+    }
+    uint64_t *scratch = malloc(sizeof(uint64_t) * count);
+    if (scratch == NULL)
+    {
+        return false;
+    }
+    SchedulePercentiles_t percentiles[PCB_METRIC_COUNT];
+    for (size_t metric = 0; metric < PCB_METRIC_COUNT; metric++)
+    {
+        schedule_percentiles(metrics, count, (PcbMetric_t)metric, scratch, &percentiles[metric]);
+    }
+    free(scratch);
+
+    fprintf(file, "%-10s %16s %16s %16s\n", "Percentile", "Waiting", "Turnaround", "Response");
+    const char *rows[] = {"p50", "p90", "p99", "p99.9", "max"};
+    for (size_t row = 0; row < sizeof(rows) / sizeof(rows[0]); row++)
+    {
+        fprintf(file, "%-10s", rows[row]);
+        for (size_t metric = 0; metric < PCB_METRIC_COUNT; metric++)
+        {
+            const uint64_t values[] = {percentiles[metric].p50, percentiles[metric].p90, percentiles[metric].p99,
+                                       percentiles[metric].p999, percentiles[metric].max};
+            fprintf(file, " %16llu", (unsigned long long)values[row]);
+        }
+        fprintf(file, "\n");
+    }
+    return true;
+}
@@ -0,0 +1,413 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "schedule_state.h"
+
+// A pcb waiting to arrive, or queued for round robin with how much of its burst is left
+typedef struct
+{
+    uint64_t arrival;
+    uint64_t burst;
+    uint64_t remaining;
+    uint32_t index; // Order the pcb was given in, the base trace and then every append, breaks arrival ties
+} state_pcb_t;
+
+// The sorted base trace, shared read only by a state and every clone of it
+typedef struct
+{
+    state_pcb_t *pcbs;
+    size_t count;
+    atomic_size_t references;
+} state_trace_t;
+
+struct schedule_state
+{
+    ScheduleStateAlgorithm_t algorithm;
+    size_t quantum;
+    bool failed; // Set if the ready queue couldn't grow, the schedule is incomplete from then on
+
+    state_trace_t *trace;
+    size_t next_base;     // Next base pcb to arrive
+    state_pcb_t *extra;   // Appended pcbs that haven't arrived yet, sorted like the base trace
+    size_t extra_count;   // Number of appended pcbs that haven't arrived yet
+    size_t extra_head;    // Next appended pcb to arrive
+    uint32_t next_index;  // Index the next appended pcb gets
+
+    state_pcb_t *ring; // Round robin ready queue
+    size_t ring_head;
+    size_t ring_size;
+    size_t ring_capacity;
+
+    uint64_t time;     // Time the schedule has been simulated up to
+    uint64_t frontier; // Earliest arrival that can still be appended
+    uint64_t last_index;
+    uint64_t completed;
+    uint64_t dispatches; // Times the cpu went to a different pcb than the one before, the first one included
+    uint64_t total_turnaround_time;
+    uint64_t total_waiting_time;
+    uint64_t total_response_time;
+};
+
+// Arrival order, the index breaks ties so pcbs given first go first
+static int compare_state_pcb(const void *a, const void *b)
+{
+    const state_pcb_t *pcb_a = (const state_pcb_t *)a;
+    const state_pcb_t *pcb_b = (const state_pcb_t *)b;
+    if (pcb_a->arrival != pcb_b->arrival)
+    {
+        return pcb_a->arrival < pcb_b->arrival ? -1 : 1;
+    }
+    return pcb_a->index < pcb_b->index ? -1 : (pcb_a->index > pcb_b->index);
+}
+
+// Private function that copies pcbs into sorted state pcbs, numbering them from first_index
+static void sort_state_pcbs(const ProcessControlBlock_t *pcbs, size_t count, uint32_t first_index, state_pcb_t *sorted)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        sorted[i].arrival = pcbs[i].arrival;
+        sorted[i].burst = pcbs[i].remaining_burst_time;
+        sorted[i].remaining = pcbs[i].remaining_burst_time;
+        sorted[i].index = first_index + (uint32_t)i;
+    }
+    qsort(sorted, count, sizeof(state_pcb_t), compare_state_pcb);
+}
+
+schedule_state_t *schedule_state_create(const ProcessControlBlock_t *pcbs, size_t count, ScheduleStateAlgorithm_t algorithm, size_t quantum)
+{
+    if ((pcbs == NULL && count > 0) || count > UINT32_MAX || (algorithm != SCHEDULE_STATE_FCFS && algorithm != SCHEDULE_STATE_RR) ||
+        (algorithm == SCHEDULE_STATE_RR && quantum == 0))
+    {
+        return NULL;
+    }
+    schedule_state_t *state = calloc(1, sizeof(schedule_state_t));
+    state_trace_t *trace = calloc(1, sizeof(state_trace_t));
+    state_pcb_t *sorted = malloc(sizeof(state_pcb_t) * (count ? count : 1));
+    if (state == NULL || trace == NULL || sorted == NULL)
+    {
+        free(state);
+        free(trace);
+        free(sorted);
+        return NULL;
+    }
+    sort_state_pcbs(pcbs, count, 0, sorted);
+    trace->pcbs = sorted;
+    trace->count = count;
+    atomic_init(&trace->references, 1);
+
+    state->algorithm = algorithm;
+    state->quantum = quantum;
+    state->trace = trace;
+    state->next_index = (uint32_t)count;
+    state->last_index = UINT64_MAX;
+    return state;
+}
+
+schedule_state_t *schedule_state_clone(const schedule_state_t *state)
+{
+    if (state == NULL)
+    {
+        return NULL;
+    }
+    schedule_state_t *clone = malloc(sizeof(schedule_state_t));
+    if (clone == NULL)
+    {
+        return NULL;
+    }
+    *clone = *state;
+    // Only the appends still to arrive and the queued pcbs are copied, both unwrapped to the start of their arrays
+    size_t extra_pending = state->extra_count - state->extra_head;
+    clone->extra = extra_pending ? malloc(sizeof(state_pcb_t) * extra_pending) : NULL;
+    clone->extra_count = extra_pending;
+    clone->extra_head = 0;
+    clone->ring = state->ring_size ? malloc(sizeof(state_pcb_t) * state->ring_size) : NULL;
+    clone->ring_head = 0;
+    clone->ring_capacity = state->ring_size;
+    if ((extra_pending && clone->extra == NULL) || (state->ring_size && clone->ring == NULL))
+    {
+        free(clone->extra);
+        free(clone->ring);
+        free(clone);
+        return NULL;
+    }
+    if (extra_pending)
+    {
+        memcpy(clone->extra, state->extra + state->extra_head, sizeof(state_pcb_t) * extra_pending);
+    }
+    for (size_t i = 0; i < state->ring_size; i++)
+    {
+        clone->ring[i] = state->ring[(state->ring_head + i) % state->ring_capacity];
+    }
+    atomic_fetch_add(&clone->trace->references, 1);
+    return clone;
+}
+
+void schedule_state_destroy(schedule_state_t *state)
+{
+    if (state == NULL)
+    {
+        return;
+    }
+    if (atomic_fetch_sub(&state->trace->references, 1) == 1)
+    {
+        free(state->trace->pcbs);
+        free(state->trace);
+    }
+    free(state->extra);
+    free(state->ring);
+    free(state);
+}
+
+// Private function that finds the next pcb to arrive out of the base trace and the appends, NULL once there are none
+static const state_pcb_t *peek_arrival(const schedule_state_t *state)
+{
+    const state_pcb_t *base = state->next_base < state->trace->count ? &state->trace->pcbs[state->next_base] : NULL;
+    const state_pcb_t *extra = state->extra_head < state->extra_count ? &state->extra[state->extra_head] : NULL;
+    if (base == NULL || extra == NULL)
+    {
+        return base ? base : extra;
+    }
+    return extra->arrival < base->arrival ? extra : base; // Base pcbs were given first so they win ties
+}
+
+// Private function that moves past the pcb peek_arrival returned
+static void take_arrival(schedule_state_t *state, const state_pcb_t *pcb)
+{
+    if (state->extra_head < state->extra_count && pcb == &state->extra[state->extra_head])
+    {
+        state->extra_head++;
+    }
+    else
+    {
+        state->next_base++;
+    }
+}
+
+// Private function that counts a pcb getting the cpu
+static void dispatch_pcb(schedule_state_t *state, const state_pcb_t *pcb)
+{
+    if (pcb->remaining == pcb->burst)
+    {
+        state->total_response_time += state->time - pcb->arrival;
+    }
+    state->dispatches += pcb->index != state->last_index;
+    state->last_index = pcb->index;
+}
+
+// Private function that adds a pcb finishing now to the totals
+static void complete_pcb(schedule_state_t *state, const state_pcb_t *pcb)
+{
+    uint64_t turnaround_time = state->time - pcb->arrival;
+    state->total_turnaround_time += turnaround_time;
+    state->total_waiting_time += turnaround_time - pcb->burst;
+    state->completed++;
+}
+
+// Private function that adds a pcb to the back of the round robin queue, growing it if it's full
+static bool ring_push(schedule_state_t *state, const state_pcb_t *pcb)
+{
+    if (state->ring_size == state->ring_capacity)
+    {
+        size_t capacity = state->ring_capacity ? state->ring_capacity * 2 : 64;
+        state_pcb_t *ring = malloc(sizeof(state_pcb_t) * capacity);
+        if (ring == NULL)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < state->ring_size; i++)
+        {
+            ring[i] = state->ring[(state->ring_head + i) % state->ring_capacity];
+        }
+        free(state->ring);
+        state->ring = ring;
+        state->ring_head = 0;
+        state->ring_capacity = capacity;
+    }
+    state->ring[(state->ring_head + state->ring_size++) % state->ring_capacity] = *pcb;
+    return true;
+}
+
+// Private function that queues every pcb that has arrived by now for round robin
+static bool admit_arrivals(schedule_state_t *state)
+{
+    const state_pcb_t *pcb;
+    while ((pcb = peek_arrival(state)) != NULL && pcb->arrival <= state->time)
+    {
+        if (!ring_push(state, pcb))
+        {
+            return false;
+        }
+        take_arrival(state, pcb);
+    }
+    return true;
+}
+
+// First come first served, a pcb arriving before 'until' runs before anything that arrives from 'until' on
+static void run_first_come_first_serve(schedule_state_t *state, uint64_t until, bool to_end)
+{
+    const state_pcb_t *next;
+    while ((next = peek_arrival(state)) != NULL && (to_end || next->arrival < until))
+    {
+        state_pcb_t pcb = *next;
+        take_arrival(state, next);
+        if (state->time < pcb.arrival)
+        {
+            state->time = pcb.arrival; // Idle until it arrives
+        }
+        dispatch_pcb(state, &pcb);
+        state->time += pcb.burst;
+        complete_pcb(state, &pcb);
+    }
+}
+
+// Round robin, the same schedule round_robin_view gives. Arrivals only join the queue at the end of a quantum or
+// when the queue runs empty, so it stops before the first of those that happens at 'until' or later.
+static bool run_round_robin(schedule_state_t *state, uint64_t until, bool to_end)
+{
+    for (;;)
+    {
+        if (state->ring_size == 0)
+        {
+            // Nothing is waiting, fast forward to the next arrival and queue everything there by then
+            const state_pcb_t *next = peek_arrival(state);
+            if (next == NULL)
+            {
+                return true;
+            }
+            uint64_t admit_time = state->time < next->arrival ? next->arrival : state->time;
+            if (!to_end && admit_time >= until)
+            {
+                return true;
+            }
+            state->time = admit_time;
+            if (!admit_arrivals(state))
+            {
+                return false;
+            }
+        }
+
+        state_pcb_t *head = &state->ring[state->ring_head];
+        if (!to_end && head->remaining > state->quantum && state->time + state->quantum >= until)
+        {
+            return true; // Anything arriving from 'until' on could join the queue at the end of this quantum
+        }
+        state_pcb_t pcb = *head;
+        state->ring_head = state->ring_head + 1 == state->ring_capacity ? 0 : state->ring_head + 1;
+        state->ring_size--;
+        dispatch_pcb(state, &pcb);
+        if (pcb.remaining <= state->quantum)
+        {
+            state->time += pcb.remaining;
+            complete_pcb(state, &pcb);
+        }
+        else
+        {
+            // Queue up everything that arrived meanwhile and then put it back at the end of the line
+            state->time += state->quantum;
+            pcb.remaining -= state->quantum;
+            if (!admit_arrivals(state) || !ring_push(state, &pcb))
+            {
+                return false;
+            }
+        }
+    }
+}
+
+// Private function that runs the schedule up to 'until' or to the end
+static bool run_schedule_state(schedule_state_t *state, uint64_t until, bool to_end)
+{
+    if (state->algorithm == SCHEDULE_STATE_FCFS)
+    {
+        run_first_come_first_serve(state, until, to_end);
+    }
+    else if (!run_round_robin(state, until, to_end))
+    {
+        state->failed = true;
+    }
+    return !state->failed;
+}
+
+bool schedule_state_advance(schedule_state_t *state, uint64_t time)
+{
+    if (state == NULL || state->failed)
+    {
+        return false;
+    }
+    if (time > state->frontier)
+    {
+        state->frontier = time;
+    }
+    return run_schedule_state(state, state->frontier, false);
+}
+
+bool schedule_state_append(schedule_state_t *state, const ProcessControlBlock_t *pcbs, size_t count)
+{
+    if (state == NULL || state->failed || (pcbs == NULL && count > 0) || count > UINT32_MAX - (size_t)state->next_index)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pcbs[i].arrival < state->frontier)
+        {
+            return false; // That part of the schedule has already been decided
+        }
+    }
+    size_t pending = state->extra_count - state->extra_head;
+    state_pcb_t *added = malloc(sizeof(state_pcb_t) * (count ? count : 1));
+    state_pcb_t *merged = malloc(sizeof(state_pcb_t) * (pending + count ? pending + count : 1));
+    if (added == NULL || merged == NULL)
+    {
+        free(added);
+        free(merged);
+        return false;
+    }
+    sort_state_pcbs(pcbs, count, state->next_index, added);
+
+    // Merge the new pcbs in behind the earlier appends, which win ties since they were given first
+    const state_pcb_t *earlier = state->extra + state->extra_head;
+    size_t i = 0, j = 0, k = 0;
+    while (i < pending || j < count)
+    {
+        if (j == count || (i < pending && earlier[i].arrival <= added[j].arrival))
+        {
+            merged[k++] = earlier[i++];
+        }
+        else
+        {
+            merged[k++] = added[j++];
+        }
+    }
+    free(added);
+    free(state->extra);
+    state->extra = merged;
+    state->extra_count = k;
+    state->extra_head = 0;
+    state->next_index += (uint32_t)count;
+    return true;
+}
+
+bool schedule_state_finish(schedule_state_t *state, ScheduleResult_t *result)
+{
+    if (state == NULL || result == NULL || state->failed || !run_schedule_state(state, 0, true) || state->completed == 0)
+    {
+        return false;
+    }
+    if (state->time > state->frontier)
+    {
+        state->frontier = state->time; // Anything appended now arrives after the schedule so far
+    }
+    result->average_turnaround_time = (double)state->total_turnaround_time / state->completed;
+    result->average_waiting_time = (double)state->total_waiting_time / state->completed;
+    result->total_run_time = state->time;
+    result->average_response_time = (double)state->total_response_time / state->completed;
+    result->context_switches = state->dispatches - 1; // The first dispatch isn't a switch
+    result->overhead_time = 0;
+    return true;
+}
+
+uint64_t schedule_state_frontier(const schedule_state_t *state)
+{
+    return state ? state->frontier : 0;
+}
@@ -0,0 +1,111 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "schedule_timeline.h"
+
+ScheduleTimeline_t *schedule_timeline_create(size_t capacity)
+{
+    if (capacity == 0)
+    {
+        return NULL;
+    }
+    ScheduleTimeline_t *timeline = calloc(1, sizeof(ScheduleTimeline_t));
+    if (timeline == NULL)
+    {
+        return NULL;
+    }
+    timeline->segments = malloc(sizeof(ScheduleSegment_t) * capacity);
+    if (timeline->segments == NULL)
+    {
+        free(timeline);
+        return NULL;
+    }
+    timeline->capacity = capacity;
+    return timeline;
+}
+
+void schedule_timeline_destroy(ScheduleTimeline_t *timeline)
+{
+    if (timeline != NULL)
+    {
+        free(timeline->segments);
+        free(timeline);
+    }
+}
+
+void schedule_timeline_clear(ScheduleTimeline_t *timeline)
+{
+    if (timeline != NULL)
+    {
+        timeline->head = 0;
+        timeline->size = 0;
+        timeline->dropped = 0;
+    }
+}
+
+ScheduleSegment_t schedule_timeline_at(const ScheduleTimeline_t *timeline, size_t index)
+{
+    ScheduleSegment_t segment;
+    memset(&segment, 0, sizeof(ScheduleSegment_t));
+    if (timeline != NULL && index < timeline->size)
+    {
+        segment = timeline->segments[(timeline->head + index) % timeline->capacity];
+    }
+    return segment;
+}
+
+void json_escape(const char *str, char *dst)
+{
+    for (; *str; str++)
+    {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\')
+        {
+            *dst++ = '\\';
+            *dst++ = (char)c;
+        }
+        else if (c < 0x20)
+        {
+            dst += sprintf(dst, "\\u%04x", c); // Control characters have to be escaped
+        }
+        else
+        {
+            *dst++ = (char)c;
+        }
+    }
+    *dst = '\0';
+}
+
+bool schedule_timeline_write_chrome_trace(const ScheduleTimeline_t *timeline, const char *name, const char *output_file)
+{
+    if (timeline == NULL || name == NULL || output_file == NULL)
+    {
+        return false;
+    }
+    char *escaped_name = malloc(strlen(name) * 6 + 1);
+    FILE *fp = escaped_name != NULL ? fopen(output_file, "w") : NULL;
+    if (fp == NULL)
+    {
+        free(escaped_name);
+        return false;
+    }
+    json_escape(name, escaped_name);
+    // The schedule is one process with a thread per cpu, every segment is a complete ("X") event named after its pcb
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"%s\"}}", escaped_name);
+    free(escaped_name);
+    uint32_t cpus = 0;
+    for (size_t i = 0; i < timeline->size; i++)
+    {
+        ScheduleSegment_t segment = schedule_timeline_at(timeline, i);
+        fprintf(fp, ",\n{\"name\":\"pcb %u\",\"cat\":\"pcb\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu,\"args\":{\"pcb\":%u}}",
+                segment.pid, segment.cpu, (unsigned long long)segment.start, (unsigned long long)(segment.end - segment.start), segment.pid);
+        cpus = segment.cpu + 1 > cpus ? segment.cpu + 1 : cpus;
+    }
+    for (uint32_t cpu = 0; cpu < cpus; cpu++)
+    {
+        fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"cpu %u\"}}", cpu, cpu);
+    }
+    fprintf(fp, "\n],\"otherData\":{\"dropped_segments\":%llu}}\n", (unsigned long long)timeline->dropped);
+    bool success = !ferror(fp);
+    return fclose(fp) == 0 && success;
+}
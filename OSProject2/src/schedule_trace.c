@@ -0,0 +1,119 @@
+#include <stdlib.h>
+
+#include "schedule_trace.h"
+
+ScheduleTrace_t *schedule_trace_create(size_t capacity, ScheduleTraceFlush_t flush, void *flush_arg)
+{
+    if (capacity == 0 || capacity > SIZE_MAX / 2 / sizeof(ScheduleEvent_t))
+    {
+        return NULL;
+    }
+    // A power of two so a slot is a mask away from the event count
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    ScheduleTrace_t *trace = calloc(1, sizeof(ScheduleTrace_t));
+    if (trace == NULL)
+    {
+        return NULL;
+    }
+    trace->events = malloc(sizeof(ScheduleEvent_t) * size);
+    if (trace->events == NULL)
+    {
+        free(trace);
+        return NULL;
+    }
+    trace->mask = size - 1;
+    trace->flush = flush;
+    trace->flush_arg = flush_arg;
+    return trace;
+}
+
+void schedule_trace_destroy(ScheduleTrace_t *trace)
+{
+    if (trace != NULL)
+    {
+        free(trace->events);
+        free(trace);
+    }
+}
+
+// Private function that hands the events from tail up to head to the flush callback, in at most two pieces since the
+// ring may wrap
+static void flush_events(ScheduleTrace_t *trace, uint64_t tail, uint64_t head)
+{
+    size_t start = (size_t)(tail & trace->mask);
+    size_t count = (size_t)(head - tail);
+    size_t first = count < trace->mask + 1 - start ? count : trace->mask + 1 - start;
+    if (first > 0)
+    {
+        trace->flush(&trace->events[start], first, trace->flush_arg);
+    }
+    if (count > first)
+    {
+        trace->flush(trace->events, count - first, trace->flush_arg);
+    }
+}
+
+bool schedule_trace_flush(ScheduleTrace_t *trace)
+{
+    if (trace == NULL || trace->flush == NULL)
+    {
+        return false;
+    }
+    uint64_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE);
+    flush_events(trace, tail, head);
+    __atomic_store_n(&trace->tail, head, __ATOMIC_RELEASE);
+    return true;
+}
+
+void schedule_trace_overflow(ScheduleTrace_t *trace)
+{
+    if (trace->flush != NULL)
+    {
+        schedule_trace_flush(trace);
+        return;
+    }
+    // Drop the oldest event, unless a drain has made room in the meantime
+    uint64_t tail = __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE);
+    while (trace->head - tail > trace->mask)
+    {
+        if (__atomic_compare_exchange_n(&trace->tail, &tail, tail + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            trace->dropped++;
+            return;
+        }
+    }
+}
+
+size_t schedule_trace_drain(ScheduleTrace_t *trace, ScheduleEvent_t *events, size_t max_count)
+{
+    if (trace == NULL || events == NULL)
+    {
+        return 0;
+    }
+    uint64_t tail = __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        uint64_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+        size_t count = head - tail < max_count ? (size_t)(head - tail) : max_count;
+        for (size_t i = 0; i < count; i++)
+        {
+            events[i] = trace->events[(tail + i) & trace->mask];
+        }
+        // The recording thread may have dropped some of these and reused their slots while they were copied, they
+        // only count if the tail hasn't moved
+        if (__atomic_compare_exchange_n(&trace->tail, &tail, tail + count, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return count;
+        }
+    }
+}
+
+void schedule_trace_write_events(const ScheduleEvent_t *events, size_t count, void *file)
+{
+    fwrite(events, sizeof(ScheduleEvent_t), count, (FILE *)file);
+}
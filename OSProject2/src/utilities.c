@@ -1,8 +1,16 @@
+#define _POSIX_C_SOURCE 200809L // Needed for open and write with -std=c11
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "dyn_array.h"
 #include "processing_scheduling.h"
+#include "utilities.h"
 
 /*Start of test helpers*/
 void print_pcb_array(ProcessControlBlock_t *pcb_array, size_t count)
@@ -11,13 +19,13 @@ void print_pcb_array(ProcessControlBlock_t *pcb_array, size_t count)
     {
         ProcessControlBlock_t pcb = pcb_array[i];
         printf("PCB #%zu:\n", i + 1);
-        printf("Remaining Burst Time: %u\n", pcb.remaining_burst_time);
-        printf("Arrival Time: %u\n", pcb.arrival);
+        printf("Remaining Burst Time: %" PRIu64 "\n", pcb.remaining_burst_time);
+        printf("Arrival Time: %" PRIu64 "\n", pcb.arrival);
         printf("Priority: %u\n\n", pcb.priority);
     }
 }
 
-ProcessControlBlock_t *create_pcb(uint32_t arrival, uint32_t priority, uint32_t remaining_burst_time, bool started, ProcessControlBlock_t *ptr)
+ProcessControlBlock_t *create_pcb(uint64_t arrival, uint32_t priority, uint64_t remaining_burst_time, bool started, ProcessControlBlock_t *ptr)
 {
     // If ptr is NULL, allocate memory for a new pcb
     if (ptr == NULL)
@@ -76,13 +84,16 @@ dyn_array_t *create_dyn_pcb_array(uint32_t *arrivals, uint32_t *priorities, uint
 }
 
 // Prints to stdout if file is NULL
-void print_schedule_result(ScheduleResult_t *result, FILE *file)
+void print_schedule_result(const ScheduleResult_t *result, FILE *file)
 {
     // Print the schedule result to a FILE variable
     FILE *output = file == NULL ? stdout : file;
     fprintf(output, "Average Waiting Time: %f\n", result->average_waiting_time);
     fprintf(output, "Average Turnaround Time: %f\n", result->average_turnaround_time);
-    fprintf(output, "Total Run time: %lu\n", result->total_run_time);
+    fprintf(output, "Total Run time: %" PRIu64 "\n", result->total_run_time);
+    fprintf(output, "Average Response Time: %f\n", result->average_response_time);
+    fprintf(output, "Context Switches: %" PRIu64 "\n", result->context_switches);
+    fprintf(output, "Switch Overhead Time: %" PRIu64 "\n", result->overhead_time);
 }
 /*End of test helpers*/
 
@@ -93,6 +104,7 @@ void print_schedule_result(ScheduleResult_t *result, FILE *file)
 #define RR "RR"
 #define SJF "SJF"
 #define SRTF "SRTF"
+#define ALL "all"
 
 // Wrapper for strncmp
 bool str_is_equal(char *str1, char *str2, int char_ct)
@@ -125,6 +137,11 @@ bool is_srtf(char *str)
     return str_is_equal(str, SRTF, 5) || str_is_equal(str, "shortest_remaining_time_first", 30); //Check str equality
 }
 
+bool is_all(char *str)
+{
+    return str_is_equal(str, ALL, 4) || str_is_equal(str, "ALL", 4); //Check str equality
+}
+
 void print_valid_algorithms()
 {
     printf("The valid algorthims are:\n");
@@ -132,11 +149,602 @@ void print_valid_algorithms()
     printf("Shortest job first: \'%s\' OR \'shortest_job_first\'.\n", SJF);
     printf("Round robin: \'%s\' OR \'round_robin\'.\n", RR);
     printf("Shortest remaining time first: \'%s\' OR \'shortest_remaining_time_first\'.\n", SRTF);
+    printf("Every algorithm on one load: \'%s\' (round robin only runs when a quantum is given).\n", ALL);
+}
+
+bool run_schedule(const char *algorithm, dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum)
+{
+    if (algorithm == NULL)
+    {
+        return false;
+    }
+    if (strcmp(algorithm, FCFS) == 0)
+    {
+        return first_come_first_serve(ready_queue, result);
+    }
+    if (strcmp(algorithm, SJF) == 0)
+    {
+        return shortest_job_first(ready_queue, result);
+    }
+    if (strcmp(algorithm, RR) == 0)
+    {
+        return round_robin(ready_queue, result, quantum);
+    }
+    if (strcmp(algorithm, SRTF) == 0)
+    {
+        return shortest_remaining_time_first(ready_queue, result);
+    }
+    return false;
+}
+
+bool run_schedule_view(const char *algorithm, const ProcessControlBlock_t *pcbs, size_t count, ScheduleResult_t *result, size_t quantum, ScheduleContext_t *context)
+{
+    if (algorithm == NULL)
+    {
+        return false;
+    }
+    if (strcmp(algorithm, FCFS) == 0)
+    {
+        return first_come_first_serve_view(pcbs, count, result, context);
+    }
+    if (strcmp(algorithm, SJF) == 0)
+    {
+        return shortest_job_first_view(pcbs, count, result, context);
+    }
+    if (strcmp(algorithm, RR) == 0)
+    {
+        return round_robin_view(pcbs, count, result, quantum, context);
+    }
+    if (strcmp(algorithm, SRTF) == 0)
+    {
+        return shortest_remaining_time_first_view(pcbs, count, result, context);
+    }
+    return false;
+}
+
+uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+const char *canonical_algorithm(char *str)
+{
+    // Map every accepted spelling onto the short name
+    if (is_fcfs(str))
+    {
+        return FCFS;
+    }
+    if (is_sjf(str))
+    {
+        return SJF;
+    }
+    if (is_rr(str))
+    {
+        return RR;
+    }
+    if (is_srtf(str))
+    {
+        return SRTF;
+    }
+    return NULL;
+}
+
+bool is_csv_file(const char *path)
+{
+    // Find the extension (the text after the last '.')
+    const char *extension = strrchr(path, '.');
+    if (extension == NULL)
+    {
+        return false;
+    }
+    return strcmp(extension, ".csv") == 0 || strcmp(extension, ".tsv") == 0; //Check str equality
+}
+
+#define MAX_QUANTUM_RANGE_COUNT (1 << 16)
+
+size_t *parse_quantum_range(const char *spec, size_t *count)
+{
+    if (spec == NULL || count == NULL)
+    {
+        return NULL;
+    }
+    size_t start = 0;
+    size_t end = 0;
+    size_t step = 1;
+    bool multiply = false;
+    int consumed = 0;
+    if (sscanf(spec, "%zu:%zu%n", &start, &end, &consumed) != 2 || start == 0 || end < start)
+    {
+        return NULL;
+    }
+    const char *step_spec = spec + consumed;
+    if (*step_spec == ':')
+    {
+        step_spec++;
+        if (*step_spec == 'x' || *step_spec == 'X')
+        {
+            multiply = true;
+            step_spec++;
+        }
+        else if (*step_spec == '+')
+        {
+            step_spec++;
+        }
+        // Only digits may follow, sscanf alone would accept signs and trailing junk
+        int step_length = 0;
+        if (*step_spec < '0' || *step_spec > '9' || sscanf(step_spec, "%zu%n", &step, &step_length) != 1 || step_spec[step_length] != '\0')
+        {
+            return NULL;
+        }
+    }
+    else if (*step_spec != '\0')
+    {
+        return NULL;
+    }
+    if (step == 0 || (multiply && step < 2))
+    {
+        return NULL; // The range would never reach its end
+    }
+
+    // Count first so the list is allocated once
+    size_t quantum_count = 0;
+    for (size_t quantum = start; quantum <= end; quantum = multiply ? quantum * step : quantum + step)
+    {
+        if (++quantum_count > MAX_QUANTUM_RANGE_COUNT)
+        {
+            return NULL;
+        }
+        if ((multiply && quantum > end / step) || (!multiply && quantum > end - step))
+        {
+            break; // The next step would pass the end (or overflow)
+        }
+    }
+    size_t *quanta = malloc(sizeof(size_t) * quantum_count);
+    if (quanta == NULL)
+    {
+        return NULL;
+    }
+    size_t quantum = start;
+    for (size_t i = 0; i < quantum_count; i++)
+    {
+        quanta[i] = quantum;
+        quantum = multiply ? quantum * step : quantum + step;
+    }
+    *count = quantum_count;
+    return quanta;
+}
+
+#define RECORD_BUFFER_SIZE 1024 // Room for everything in a record except the input file name
+
+bool append_schedule_record(const char *results_file, const ScheduleRecord_t *record)
+{
+    if (results_file == NULL || record == NULL || record->algorithm == NULL || record->result == NULL)
+    {
+        return false;
+    }
+    const char *input_file = record->input_file ? record->input_file : "";
+    size_t escaped_size = strlen(input_file) * 6 + 1;
+    size_t buffer_size = RECORD_BUFFER_SIZE + escaped_size;
+    char *escaped_input = malloc(escaped_size);
+    char *buffer = malloc(buffer_size);
+    if (escaped_input == NULL || buffer == NULL)
+    {
+        free(escaped_input);
+        free(buffer);
+        return false;
+    }
+    json_escape(input_file, escaped_input);
+
+    // Build the entire record up front so it can be written with a single write call
+    const ScheduleResult_t *result = record->result;
+    int length = snprintf(buffer, buffer_size,
+                          "{\"timestamp\":%lld,\"algorithm\":\"%s\",\"quantum\":%zu,\"input\":\"%s\",\"input_hash\":\"%016" PRIx64 "\","
+                          "\"process_count\":%zu,\"average_waiting_time\":%f,\"average_turnaround_time\":%f,\"total_run_time\":%" PRIu64 ","
+                          "\"average_response_time\":%f,\"context_switches\":%" PRIu64 ",\"overhead_time\":%" PRIu64 "}\n",
+                          (long long)time(NULL), record->algorithm, record->quantum, escaped_input, record->input_hash,
+                          record->process_count, result->average_waiting_time, result->average_turnaround_time, result->total_run_time,
+                          result->average_response_time, result->context_switches, result->overhead_time);
+    free(escaped_input);
+    if (length < 0 || (size_t)length >= buffer_size)
+    {
+        free(buffer);
+        return false;
+    }
+
+    // O_APPEND makes every write land at the current end of the file, so records from concurrent runs never overlap
+    int fd = open(results_file, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        free(buffer);
+        return false;
+    }
+    ssize_t written = write(fd, buffer, (size_t)length);
+    bool success = written == length;
+    success = close(fd) == 0 && success;
+    free(buffer);
+    return success;
 }
 /*End of analysis helpers*/
 
+/*Start of workload generator*/
+
+void workload_spec_init(WorkloadSpec_t *spec, uint64_t seed)
+{
+    if (spec == NULL)
+    {
+        return;
+    }
+    spec->seed = seed;
+    spec->arrival = WORKLOAD_ARRIVAL_POISSON;
+    spec->mean_interarrival = 10;
+    spec->batch_size = 16;
+    spec->burst = WORKLOAD_BURST_EXPONENTIAL;
+    spec->min_burst = 1;
+    spec->max_burst = 1000;
+    spec->mean_burst = 9;
+    spec->long_job_ratio = 10;
+    spec->priority = WORKLOAD_PRIORITY_UNIFORM;
+    spec->priority_levels = 8;
+    spec->order = WORKLOAD_ORDER_ARRIVAL;
+}
+
+// Where the generator is up to between pcbs
+typedef struct
+{
+    uint64_t random;     // splitmix64 state
+    uint64_t time;       // Arrival time of the next pcb
+    uint32_t batch_left; // Pcbs still to arrive in the current batch
+    bool batched;        // Set once the first batch has started
+} workload_state_t;
+
+// splitmix64, a handful of instructions per value and consecutive seeds still give unrelated workloads
+uint64_t workload_random_next(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t workload_random(workload_state_t *state)
+{
+    return workload_random_next(&state->random);
+}
+
+// Uniform over [0, bound]
+static uint64_t workload_uniform(workload_state_t *state, uint64_t bound)
+{
+    uint64_t value = workload_random(state);
+    return bound == UINT64_MAX ? value : value % (bound + 1);
+}
+
+// Exponentially distributed with the given mean, rounded to the nearest time unit
+static uint64_t workload_exponential(workload_state_t *state, double mean)
+{
+    double unit = (double)(workload_random(state) >> 11) * (1.0 / 9007199254740992.0); // [0, 1) from 53 bits
+    double value = -mean * log(1.0 - unit) + 0.5;
+    return value >= 18446744073709551615.0 ? UINT64_MAX : (uint64_t)value;
+}
+
+static uint64_t saturating_add(uint64_t a, uint64_t b)
+{
+    return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+
+static bool workload_spec_valid(const WorkloadSpec_t *spec)
+{
+    return spec != NULL && spec->arrival <= WORKLOAD_ARRIVAL_BATCHED && spec->burst <= WORKLOAD_BURST_BIMODAL &&
+           spec->priority <= WORKLOAD_PRIORITY_SKEWED && spec->order <= WORKLOAD_ORDER_SHUFFLED && spec->min_burst <= spec->max_burst &&
+           (spec->arrival != WORKLOAD_ARRIVAL_BATCHED || spec->batch_size > 0) && (spec->burst != WORKLOAD_BURST_BIMODAL || spec->long_job_ratio > 0) &&
+           (spec->priority == WORKLOAD_PRIORITY_CONSTANT || spec->priority_levels > 0);
+}
+
+// Draws the next pcb, arrivals come out in increasing order
+static void workload_next(const WorkloadSpec_t *spec, workload_state_t *state, uint64_t *arrival, uint64_t *burst, uint32_t *priority)
+{
+    switch (spec->arrival)
+    {
+    case WORKLOAD_ARRIVAL_SIMULTANEOUS:
+        *arrival = 0;
+        break;
+    case WORKLOAD_ARRIVAL_UNIFORM:
+        *arrival = state->time;
+        state->time = saturating_add(state->time, workload_uniform(state, saturating_add(spec->mean_interarrival, spec->mean_interarrival)));
+        break;
+    case WORKLOAD_ARRIVAL_POISSON:
+        *arrival = state->time;
+        state->time = saturating_add(state->time, workload_exponential(state, (double)spec->mean_interarrival));
+        break;
+    default:
+        if (state->batch_left == 0)
+        {
+            state->batch_left = spec->batch_size;
+            if (state->batched)
+            {
+                state->time = saturating_add(state->time, workload_exponential(state, (double)spec->mean_interarrival * spec->batch_size));
+            }
+            state->batched = true;
+        }
+        state->batch_left--;
+        *arrival = state->time;
+        break;
+    }
+
+    uint64_t value;
+    switch (spec->burst)
+    {
+    case WORKLOAD_BURST_CONSTANT:
+        value = spec->mean_burst;
+        break;
+    case WORKLOAD_BURST_UNIFORM:
+        value = spec->min_burst + workload_uniform(state, spec->max_burst - spec->min_burst);
+        break;
+    case WORKLOAD_BURST_EXPONENTIAL:
+        value = workload_exponential(state, (double)spec->mean_burst);
+        break;
+    default:
+        value = workload_random(state) % spec->long_job_ratio == 0 ? spec->max_burst : spec->min_burst;
+        break;
+    }
+    *burst = value < spec->min_burst ? spec->min_burst : value > spec->max_burst ? spec->max_burst : value;
+
+    if (spec->priority == WORKLOAD_PRIORITY_CONSTANT)
+    {
+        *priority = 0;
+    }
+    else if (spec->priority == WORKLOAD_PRIORITY_UNIFORM)
+    {
+        *priority = (uint32_t)(workload_random(state) % spec->priority_levels);
+    }
+    else
+    {
+        // Every set low bit moves one level down, so each level is half as likely as the one before
+        uint64_t bits = workload_random(state);
+        uint32_t level = 0;
+        while ((bits & 1) && level + 1 < spec->priority_levels)
+        {
+            bits >>= 1;
+            level++;
+        }
+        *priority = level;
+    }
+}
+
+// Where the i'th pcb generated is written for the spec's order, shuffling happens afterwards
+static size_t workload_position(const WorkloadSpec_t *spec, size_t i, size_t count)
+{
+    return spec->order == WORKLOAD_ORDER_REVERSED ? count - 1 - i : i;
+}
+
+bool generate_workload(const WorkloadSpec_t *spec, ProcessControlBlock_t *pcbs, size_t count)
+{
+    if (!workload_spec_valid(spec) || (pcbs == NULL && count > 0))
+    {
+        return false;
+    }
+    workload_state_t state = {spec->seed, 0, 0, false};
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t arrival, burst;
+        uint32_t priority;
+        workload_next(spec, &state, &arrival, &burst, &priority);
+        create_pcb(arrival, priority, burst, false, &pcbs[workload_position(spec, i, count)]);
+    }
+    if (spec->order == WORKLOAD_ORDER_SHUFFLED)
+    {
+        // Fisher-Yates, generate_workload_columns draws the exact same swaps
+        for (size_t i = count; i > 1; i--)
+        {
+            size_t j = (size_t)workload_uniform(&state, i - 1);
+            ProcessControlBlock_t pcb = pcbs[i - 1];
+            pcbs[i - 1] = pcbs[j];
+            pcbs[j] = pcb;
+        }
+    }
+    return true;
+}
+
+dyn_array_t *generate_workload_dyn_array(const WorkloadSpec_t *spec, size_t count)
+{
+    if (!workload_spec_valid(spec) || count > SIZE_MAX / sizeof(ProcessControlBlock_t))
+    {
+        return NULL;
+    }
+    dyn_array_t *dyn_array = dyn_array_create(count, sizeof(ProcessControlBlock_t), NULL);
+    if (dyn_array == NULL)
+    {
+        return NULL;
+    }
+    // Generate straight into the array's storage rather than pushing one pcb at a time
+    generate_workload(spec, (ProcessControlBlock_t *)dyn_array->array, count);
+    dyn_array->size = count;
+    return dyn_array;
+}
+
+bool generate_workload_columns(const WorkloadSpec_t *spec, WorkloadColumns_t *columns, size_t count)
+{
+    if (!workload_spec_valid(spec) || columns == NULL ||
+        (count > 0 && (columns->arrivals == NULL || columns->bursts == NULL || columns->priorities == NULL)))
+    {
+        return false;
+    }
+    workload_state_t state = {spec->seed, 0, 0, false};
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t position = workload_position(spec, i, count);
+        workload_next(spec, &state, &columns->arrivals[position], &columns->bursts[position], &columns->priorities[position]);
+    }
+    if (spec->order == WORKLOAD_ORDER_SHUFFLED)
+    {
+        for (size_t i = count; i > 1; i--)
+        {
+            size_t j = (size_t)workload_uniform(&state, i - 1);
+            uint64_t arrival_swap = columns->arrivals[i - 1];
+            columns->arrivals[i - 1] = columns->arrivals[j];
+            columns->arrivals[j] = arrival_swap;
+            uint64_t burst_swap = columns->bursts[i - 1];
+            columns->bursts[i - 1] = columns->bursts[j];
+            columns->bursts[j] = burst_swap;
+            uint32_t priority_swap = columns->priorities[i - 1];
+            columns->priorities[i - 1] = columns->priorities[j];
+            columns->priorities[j] = priority_swap;
+        }
+    }
+    return true;
+}
+/*End of workload generator*/
+
+/*Start of perf baselines*/
+// Private function for qsort over timings
+static int compare_uint64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Private function that takes the median of sorted values
+static double sorted_median(const uint64_t *values, size_t count)
+{
+    return count % 2 ? (double)values[count / 2] : ((double)values[count / 2 - 1] + (double)values[count / 2]) / 2;
+}
+
+bool perf_summarize(const char *name, uint64_t *samples, size_t count, PerfMeasurement_t *measurement)
+{
+    if (name == NULL || samples == NULL || count == 0 || measurement == NULL)
+    {
+        return false;
+    }
+    qsort(samples, count, sizeof(uint64_t), compare_uint64);
+    double median = sorted_median(samples, count);
+    // The deviations are twice the distance to the median so they stay whole numbers when the median is a half
+    uint64_t *deviations = malloc(sizeof(uint64_t) * count);
+    if (deviations == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        double deviation = (double)samples[i] - median;
+        deviations[i] = (uint64_t)(2 * (deviation < 0 ? -deviation : deviation));
+    }
+    qsort(deviations, count, sizeof(uint64_t), compare_uint64);
+    snprintf(measurement->name, PERF_NAME_SIZE, "%s", name);
+    measurement->repetitions = count;
+    measurement->median_ns = median;
+    measurement->mad_ns = sorted_median(deviations, count) / 2;
+    measurement->min_ns = (double)samples[0];
+    free(deviations);
+    return true;
+}
+
+#define PERF_MAD_SCALE 1.4826 // Makes the MAD comparable to a standard deviation for normally distributed timings
+
+PerfVerdict_t perf_compare(const PerfMeasurement_t *baseline, const PerfMeasurement_t *current, double threshold, double noise_factor)
+{
+    double difference = current->median_ns - baseline->median_ns;
+    double magnitude = difference < 0 ? -difference : difference;
+    double mad = baseline->mad_ns > current->mad_ns ? baseline->mad_ns : current->mad_ns;
+    if (magnitude <= threshold * baseline->median_ns || magnitude <= noise_factor * PERF_MAD_SCALE * mad)
+    {
+        return PERF_UNCHANGED;
+    }
+    return difference > 0 ? PERF_SLOWER : PERF_FASTER;
+}
+
+// One measurement per line, perf_baseline_read depends on this layout
+#define PERF_RECORD_FORMAT "{\"name\": \"%s\", \"repetitions\": %zu, \"median_ns\": %.1f, \"mad_ns\": %.1f, \"min_ns\": %.1f}"
+#define PERF_RECORD_SCAN "{\"name\": \"%63[^\"]\", \"repetitions\": %zu, \"median_ns\": %lf, \"mad_ns\": %lf, \"min_ns\": %lf}"
+
+bool perf_baseline_write(const char *path, const PerfMeasurement_t *measurements, size_t count)
+{
+    if (path == NULL || (measurements == NULL && count > 0))
+    {
+        return false;
+    }
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        return false;
+    }
+    fprintf(fp, "{\n  \"timestamp\": %lld,\n  \"benchmarks\": [\n", (long long)time(NULL));
+    for (size_t i = 0; i < count; i++)
+    {
+        const PerfMeasurement_t *m = &measurements[i];
+        fprintf(fp, "    " PERF_RECORD_FORMAT "%s\n", m->name, m->repetitions, m->median_ns, m->mad_ns, m->min_ns, i + 1 < count ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    bool success = !ferror(fp);
+    return fclose(fp) == 0 && success;
+}
+
+PerfMeasurement_t *perf_baseline_read(const char *path, size_t *count)
+{
+    if (path == NULL || count == NULL)
+    {
+        return NULL;
+    }
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return NULL;
+    }
+    size_t size = 0;
+    size_t capacity = 16;
+    PerfMeasurement_t *measurements = malloc(sizeof(PerfMeasurement_t) * capacity);
+    char line[256];
+    while (measurements != NULL && fgets(line, sizeof(line), fp) != NULL)
+    {
+        const char *record = strstr(line, "{\"name\"");
+        if (record == NULL)
+        {
+            continue;
+        }
+        if (size == capacity)
+        {
+            capacity *= 2;
+            PerfMeasurement_t *grown = realloc(measurements, sizeof(PerfMeasurement_t) * capacity);
+            if (grown == NULL)
+            {
+                free(measurements);
+                measurements = NULL;
+                break;
+            }
+            measurements = grown;
+        }
+        PerfMeasurement_t *m = &measurements[size];
+        if (sscanf(record, PERF_RECORD_SCAN, m->name, &m->repetitions, &m->median_ns, &m->mad_ns, &m->min_ns) == 5)
+        {
+            size++;
+        }
+    }
+    fclose(fp);
+    if (measurements != NULL && size == 0)
+    {
+        free(measurements);
+        measurements = NULL;
+    }
+    *count = size;
+    return measurements;
+}
+
+const PerfMeasurement_t *perf_find(const PerfMeasurement_t *measurements, size_t count, const char *name)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(measurements[i].name, name) == 0)
+        {
+            return &measurements[i];
+        }
+    }
+    return NULL;
+}
+/*End of perf baselines*/
+
 /*Start of process_scheduling helpers*/
-void enqueue_processes(dyn_array_t *ready_queue, dyn_array_t *current_processes, uint32_t *current_wait_time, int (*cmp_fn)(const void *, const void *))
+void enqueue_processes(dyn_array_t *ready_queue, dyn_array_t *current_processes, uint64_t *current_wait_time, int (*cmp_fn)(const void *, const void *))
 {
     if (ready_queue->size == 0)
     {
@@ -152,9 +760,11 @@ void enqueue_processes(dyn_array_t *ready_queue, dyn_array_t *current_processes,
     {
         pcb = (ProcessControlBlock_t *)dyn_array_front(ready_queue); // Get the pcb at the front of the ready_queue
         // Note: storing dyn_array_front and following it by dyn_array_pop_front will change the value referenced by the dyn_array_front variable (this is why a new pcb with the same values is created)
-        const ProcessControlBlock_t *pcb_cpy = create_pcb(pcb->arrival, pcb->priority, pcb->remaining_burst_time, pcb->started, NULL); // Copy the pcb at the front of the ready_queue
-        dyn_array_pop_front(ready_queue);                                                                                              // Remove the pcb from the ready_queue
-        dyn_array_insert_sorted(current_processes, pcb_cpy, cmp_fn);                                                                   // Insert the pcb into the current_processes queue (this will insert based on burst time)
+        // The copy lives on the stack, insert_sorted copies it into the queue so a heap copy would only leak
+        ProcessControlBlock_t pcb_cpy;
+        create_pcb(pcb->arrival, pcb->priority, pcb->remaining_burst_time, pcb->started, &pcb_cpy); // Copy the pcb at the front of the ready_queue
+        dyn_array_pop_front(ready_queue);                                                          // Remove the pcb from the ready_queue
+        dyn_array_insert_sorted(current_processes, &pcb_cpy, cmp_fn);                              // Insert the pcb into the current_processes queue (this will insert based on burst time)
     }
 }
 
@@ -162,7 +772,8 @@ int compare_burst(const void *a, const void *b)
 {
     const ProcessControlBlock_t *pcb_a = (const ProcessControlBlock_t *)a; // Cast the "a" variable to a pcb
     const ProcessControlBlock_t *pcb_b = (const ProcessControlBlock_t *)b; // Cast the "b" variable to a pcb
-    return pcb_a->remaining_burst_time - pcb_b->remaining_burst_time;      // The pcb with the shortest burst time should be processed before the other
+    // The pcb with the shortest burst time should be processed before the other, compared rather than subtracted so 64 bit times can't overflow the int
+    return (pcb_a->remaining_burst_time > pcb_b->remaining_burst_time) - (pcb_a->remaining_burst_time < pcb_b->remaining_burst_time);
 }
 
 int compare_arrival_burst(const void *a, const void *b)
@@ -177,32 +788,34 @@ int compare_arrival_burst(const void *a, const void *b)
     {
         return 1; // pcb_b should be processed before pcb_a
     }
-    return pcb_a->remaining_burst_time - pcb_b->remaining_burst_time; // The pcb with the shortest burst time should be processed before the other
+    return (pcb_a->remaining_burst_time > pcb_b->remaining_burst_time) - (pcb_a->remaining_burst_time < pcb_b->remaining_burst_time); // The pcb with the shortest burst time should be processed before the other
 }
 
 int compare_arrival(const void *a, const void *b)
 {
     const ProcessControlBlock_t *pcb_a = (const ProcessControlBlock_t *)a; // Cast the "a" variable to a pcb
     const ProcessControlBlock_t *pcb_b = (const ProcessControlBlock_t *)b; // Cast the "b" variable to a pcb
-    return pcb_a->arrival - pcb_b->arrival; // The pcb with the shorter arrival will be first
+    return (pcb_a->arrival > pcb_b->arrival) - (pcb_a->arrival < pcb_b->arrival); // The pcb with the shorter arrival will be first
 }
 
-void write_schedule_result(ScheduleResult_t *sr, uint32_t total_turnaround_time, uint32_t total_wait_time, uint32_t total_run_time, uint32_t process_count)
+void write_schedule_result(ScheduleResult_t *sr, uint64_t total_turnaround_time, uint64_t total_wait_time, uint64_t total_run_time, size_t process_count)
 {
-    sr->average_turnaround_time = (float)total_turnaround_time / process_count; // Calculate and store the average turnaround time
-    sr->average_waiting_time = (float)total_wait_time / process_count;          // Calculate and store the average wait time
+    sr->average_turnaround_time = (double)total_turnaround_time / process_count; // Calculate and store the average turnaround time
+    sr->average_waiting_time = (double)total_wait_time / process_count;          // Calculate and store the average wait time
     sr->total_run_time = total_run_time;                                        // Store the total run time
 }
 
-#define READMELOC "../readme.md"
-
-FILE *get_readme()
+FILE *get_readme(const char *readme_path)
 {
-    // Open the readme.md file for both reading and writing
-    FILE *readme_file = fopen(READMELOC, "r+");
+    if (readme_path == NULL)
+    {
+        return NULL;
+    }
+    // Open the readme file for both reading and writing
+    FILE *readme_file = fopen(readme_path, "r+");
     if (readme_file == NULL)
     {
-        fprintf(stderr, "Error opening ../readme.md for reading and writing\n");
+        fprintf(stderr, "Error opening %s for reading and writing\n", readme_path);
         return NULL;
     }
     return readme_file;
@@ -229,20 +842,75 @@ void seek_file(FILE *file, int line_number)
     }
 }
 
-bool print_to_readme(ScheduleResult_t *result, int line_number)
+// The readme block keeps the three lines it always had, the response time and switch counts go to stdout and the results file
+#define README_RESULT_LINES 3
+
+static void print_readme_result(const ScheduleResult_t *result, FILE *file)
+{
+    fprintf(file, "Average Waiting Time: %f\n", result->average_waiting_time);
+    fprintf(file, "Average Turnaround Time: %f\n", result->average_turnaround_time);
+    fprintf(file, "Total Run time: %" PRIu64 "\n", result->total_run_time);
+}
+
+// Returns the offset of the start of the line after 'lines' more lines from 'offset', or 'size' if the text ends first
+static size_t skip_lines(const char *text, size_t size, size_t offset, int lines)
+{
+    for (int i = 0; i < lines && offset < size; ++i)
+    {
+        const char *newline = memchr(text + offset, '\n', size - offset);
+        offset = newline == NULL ? size : (size_t)(newline - text) + 1;
+    }
+    return offset;
+}
+
+bool print_to_readme(const char *readme_path, const ScheduleResult_t *result, int line_number)
 {
     //Open the readme file
-    FILE *readme_file = get_readme();
+    FILE *readme_file = get_readme(readme_path);
     if (readme_file == NULL)
     {
         return false;
     }
-    //Seek to the desired line number
-    seek_file(readme_file, line_number - 1);
-    //Print the result to the readme
-    print_schedule_result(result, readme_file);
-    // Close the file
+    // Read all of it, the old block's lines can be longer or shorter than the new ones so the rest has to move with it
+    bool success = fseek(readme_file, 0, SEEK_END) == 0;
+    long size = success ? ftell(readme_file) : -1;
+    char *contents = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    success = contents != NULL && fseek(readme_file, 0, SEEK_SET) == 0 && fread(contents, 1, (size_t)size, readme_file) == (size_t)size;
     fclose(readme_file);
-    return true;
+    if (!success)
+    {
+        free(contents);
+        return false;
+    }
+
+    size_t block_start = skip_lines(contents, (size_t)size, 0, line_number - 1);
+    size_t block_end = skip_lines(contents, (size_t)size, block_start, README_RESULT_LINES);
+
+    // Written to a temporary file and renamed over the readme so a failed write never leaves it half rewritten
+    size_t length = strlen(readme_path);
+    char *temporary_path = malloc(length + 5);
+    FILE *fp = NULL;
+    if (temporary_path != NULL)
+    {
+        memcpy(temporary_path, readme_path, length);
+        memcpy(temporary_path + length, ".tmp", 5);
+        fp = fopen(temporary_path, "w");
+    }
+    success = fp != NULL;
+    if (success)
+    {
+        success = fwrite(contents, 1, block_start, fp) == block_start;
+        print_readme_result(result, fp);
+        success = success && fwrite(contents + block_end, 1, (size_t)size - block_end, fp) == (size_t)size - block_end;
+        success = fclose(fp) == 0 && success;
+        success = success && rename(temporary_path, readme_path) == 0;
+        if (!success)
+        {
+            remove(temporary_path);
+        }
+    }
+    free(temporary_path);
+    free(contents);
+    return success;
 }
 /*End of process_scheduling helpers*/
\ No newline at end of file
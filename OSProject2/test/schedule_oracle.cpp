@@ -0,0 +1,520 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../include/processing_scheduling.h"
+#include "schedule_state.h"
+
+#include "utilities.h"
+
+extern "C"
+{
+#include <dyn_array.h>
+}
+
+// Differential oracle for the scheduler engines. Every engine is run side by side with a reference scheduler that
+// simulates one time unit at a time with plain linear scans, over randomized seeded workloads with lots of ties, idle
+// gaps and zero bursts. The full ScheduleResult_t and, where the engine reports them, every pcb's first run and
+// completion time have to match exactly. A mismatching workload is shrunk to a minimal reproducer before it is
+// reported. The default run is sized for the regular test suite, set HW2_ORACLE_ITERATIONS (e.g. to 1000000) for a
+// long soak and HW2_ORACLE_SEED to explore other workloads:
+//
+//   HW2_ORACLE_ITERATIONS=1000000 ./hw2_test --gtest_filter='schedule_oracle.*'
+
+#define ORACLE_DEFAULT_ITERATIONS 10000
+#define ORACLE_DEFAULT_SEED 0x5EED5EED5EEDULL
+#define ORACLE_NONE SIZE_MAX
+
+namespace
+{
+
+enum oracle_algorithm_t
+{
+    ORACLE_FCFS,
+    ORACLE_SJF,
+    ORACLE_RR,
+    ORACLE_SRTF,
+};
+
+const char *const oracle_names[] = {"FCFS", "SJF", "RR", "SRTF"};
+
+struct oracle_job_t
+{
+    uint64_t arrival;
+    uint64_t burst;
+};
+
+struct oracle_workload_t
+{
+    std::vector<oracle_job_t> jobs;
+    size_t quantum;
+};
+
+// What a run produced, the per pcb times are in the order the pcbs were given and left empty by engines that can't
+// report them
+struct oracle_outcome_t
+{
+    ScheduleResult_t result;
+    std::vector<uint64_t> first_run;
+    std::vector<uint64_t> completion;
+};
+
+// An engine under test, returns false if it refused the workload
+typedef std::function<bool(oracle_algorithm_t, const oracle_workload_t &, oracle_outcome_t *)> oracle_engine_t;
+
+uint64_t oracle_next(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t oracle_uniform(uint64_t *state, uint64_t bound)
+{
+    return oracle_next(state) % bound;
+}
+
+size_t oracle_env(const char *name, size_t fallback)
+{
+    const char *value = getenv(name);
+    unsigned long long parsed;
+    return value != NULL && sscanf(value, "%llu", &parsed) == 1 ? (size_t)parsed : fallback;
+}
+
+// Draws a small workload. Arrivals come all at once, packed together or spread out with idle gaps, and bursts come
+// from a narrow range (lots of ties) or a wide one, with the odd zero burst
+oracle_workload_t random_workload(uint64_t *state)
+{
+    oracle_workload_t workload;
+    size_t count = 1 + (size_t)(oracle_uniform(state, 8) == 0 ? oracle_uniform(state, 48) : oracle_uniform(state, 10));
+    uint64_t arrival_span = 0;
+    switch (oracle_uniform(state, 3))
+    {
+    case 0:
+        arrival_span = 1; // Everything arrives at once
+        break;
+    case 1:
+        arrival_span = count;
+        break;
+    default:
+        arrival_span = 6 * count;
+        break;
+    }
+    uint64_t burst_span = oracle_uniform(state, 2) ? 4 : 16;
+    for (size_t i = 0; i < count; i++)
+    {
+        oracle_job_t job;
+        job.arrival = oracle_uniform(state, arrival_span);
+        job.burst = oracle_uniform(state, 16) == 0 ? 0 : 1 + oracle_uniform(state, burst_span);
+        workload.jobs.push_back(job);
+    }
+    workload.quantum = 1 + (size_t)oracle_uniform(state, 6);
+    return workload;
+}
+
+std::vector<ProcessControlBlock_t> to_pcbs(const oracle_workload_t &workload)
+{
+    std::vector<ProcessControlBlock_t> pcbs(workload.jobs.size());
+    for (size_t i = 0; i < pcbs.size(); i++)
+    {
+        create_pcb(workload.jobs[i].arrival, 0, workload.jobs[i].burst, false, &pcbs[i]);
+    }
+    return pcbs;
+}
+
+// The reference scheduler. It keeps the line of arrived pcbs in arrival order (ties by burst for SJF and SRTF, then
+// by the order given, the same order the engines sort into), advances the clock one unit at a time and makes every
+// decision again from scratch by scanning the line:
+//   FCFS runs the head of the line to completion
+//   SJF  runs the shortest burst to completion, the earliest in line on ties
+//   RR   runs the head for up to a quantum, arrivals at the moment the quantum runs out go ahead of it
+//   SRTF runs the least remaining time every unit, the latest in line on ties so an equal arrival preempts
+// A pcb with a zero burst completes the moment it is dispatched.
+oracle_outcome_t reference_schedule(oracle_algorithm_t algorithm, const oracle_workload_t &workload)
+{
+    const std::vector<oracle_job_t> &jobs = workload.jobs;
+    size_t count = jobs.size();
+    bool by_burst = algorithm == ORACLE_SJF || algorithm == ORACLE_SRTF;
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (jobs[a].arrival != jobs[b].arrival)
+        {
+            return jobs[a].arrival < jobs[b].arrival;
+        }
+        return by_burst && jobs[a].burst < jobs[b].burst;
+    });
+    std::vector<size_t> rank(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        rank[order[i]] = i;
+    }
+
+    oracle_outcome_t outcome;
+    outcome.first_run.assign(count, 0);
+    outcome.completion.assign(count, 0);
+    std::vector<uint64_t> remaining(count);
+    std::vector<bool> started(count, false);
+    for (size_t i = 0; i < count; i++)
+    {
+        remaining[i] = jobs[i].burst;
+    }
+    std::deque<size_t> line;
+    size_t admitted = 0;
+    size_t finished = 0;
+    size_t running = ORACLE_NONE;
+    size_t last = ORACLE_NONE;
+    uint64_t slice = 0;
+    uint64_t dispatches = 0;
+    uint64_t time = 0;
+    while (finished < count)
+    {
+        while (admitted < count && jobs[order[admitted]].arrival <= time)
+        {
+            line.push_back(order[admitted++]);
+        }
+        if (running != ORACLE_NONE && ((algorithm == ORACLE_RR && slice == workload.quantum) || algorithm == ORACLE_SRTF))
+        {
+            line.push_back(running);
+            running = ORACLE_NONE;
+        }
+        while (running == ORACLE_NONE && !line.empty())
+        {
+            size_t pick = 0;
+            for (size_t i = 1; i < line.size(); i++)
+            {
+                size_t a = line[i];
+                size_t b = line[pick];
+                if ((algorithm == ORACLE_SJF && (jobs[a].burst < jobs[b].burst || (jobs[a].burst == jobs[b].burst && rank[a] < rank[b]))) ||
+                    (algorithm == ORACLE_SRTF && (remaining[a] < remaining[b] || (remaining[a] == remaining[b] && rank[a] > rank[b]))))
+                {
+                    pick = i;
+                }
+            }
+            size_t job = line[pick];
+            line.erase(line.begin() + (std::ptrdiff_t)pick);
+            dispatches += job != last;
+            last = job;
+            if (!started[job])
+            {
+                started[job] = true;
+                outcome.first_run[job] = time;
+            }
+            if (remaining[job] == 0)
+            {
+                outcome.completion[job] = time;
+                finished++;
+                continue;
+            }
+            running = job;
+            slice = 0;
+        }
+        if (finished == count)
+        {
+            break;
+        }
+        time++;
+        if (running != ORACLE_NONE)
+        {
+            remaining[running]--;
+            slice++;
+            if (remaining[running] == 0)
+            {
+                outcome.completion[running] = time;
+                finished++;
+                running = ORACLE_NONE;
+            }
+        }
+    }
+
+    uint64_t total_turnaround = 0;
+    uint64_t total_waiting = 0;
+    uint64_t total_response = 0;
+    uint64_t end = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total_turnaround += outcome.completion[i] - jobs[i].arrival;
+        total_waiting += outcome.completion[i] - jobs[i].arrival - jobs[i].burst;
+        total_response += outcome.first_run[i] - jobs[i].arrival;
+        end = std::max(end, outcome.completion[i]);
+    }
+    outcome.result.average_turnaround_time = (double)total_turnaround / count;
+    outcome.result.average_waiting_time = (double)total_waiting / count;
+    outcome.result.average_response_time = (double)total_response / count;
+    outcome.result.total_run_time = end;
+    outcome.result.context_switches = dispatches - 1;
+    outcome.result.overhead_time = 0;
+    return outcome;
+}
+
+// The view schedulers with per pcb metrics, which runs the copy of each loop compiled with the optional hooks
+bool view_with_metrics(oracle_algorithm_t algorithm, const oracle_workload_t &workload, oracle_outcome_t *outcome)
+{
+    std::vector<ProcessControlBlock_t> pcbs = to_pcbs(workload);
+    std::vector<uint64_t> scratch(schedule_scratch_size(pcbs.size()) / sizeof(uint64_t) + 1);
+    std::vector<PcbMetrics_t> metrics(pcbs.size());
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch.data(), scratch.size() * sizeof(uint64_t));
+    context.metrics = metrics.data();
+    if (!run_schedule_view(oracle_names[algorithm], pcbs.data(), pcbs.size(), &outcome->result, workload.quantum, &context))
+    {
+        return false;
+    }
+    for (const PcbMetrics_t &pcb_metrics : metrics)
+    {
+        outcome->first_run.push_back(pcb_metrics.first_run);
+        outcome->completion.push_back(pcb_metrics.completion);
+    }
+    return true;
+}
+
+// The dyn_array schedulers, which run the copy of each loop with the hooks folded away
+bool dyn_array_engine(oracle_algorithm_t algorithm, const oracle_workload_t &workload, oracle_outcome_t *outcome)
+{
+    std::vector<ProcessControlBlock_t> pcbs = to_pcbs(workload);
+    dyn_array_t *ready_queue = dyn_array_create(pcbs.size(), sizeof(ProcessControlBlock_t), NULL);
+    bool success = ready_queue != NULL;
+    for (size_t i = 0; success && i < pcbs.size(); i++)
+    {
+        success = dyn_array_push_back(ready_queue, &pcbs[i]);
+    }
+    success = success && run_schedule(oracle_names[algorithm], ready_queue, &outcome->result, workload.quantum);
+    dyn_array_destroy(ready_queue);
+    return success;
+}
+
+// Describes the first difference between two outcomes, empty if they match
+std::string compare_outcomes(const oracle_outcome_t &expected, const oracle_outcome_t &actual)
+{
+    std::ostringstream difference;
+    const ScheduleResult_t &e = expected.result;
+    const ScheduleResult_t &a = actual.result;
+    if (e.average_waiting_time != a.average_waiting_time || e.average_turnaround_time != a.average_turnaround_time ||
+        e.average_response_time != a.average_response_time || e.total_run_time != a.total_run_time ||
+        e.context_switches != a.context_switches || e.overhead_time != a.overhead_time)
+    {
+        difference << "result (waiting, turnaround, response, run time, switches, overhead) expected (" << e.average_waiting_time << ", "
+                   << e.average_turnaround_time << ", " << e.average_response_time << ", " << e.total_run_time << ", " << e.context_switches
+                   << ", " << e.overhead_time << ") got (" << a.average_waiting_time << ", " << a.average_turnaround_time << ", "
+                   << a.average_response_time << ", " << a.total_run_time << ", " << a.context_switches << ", " << a.overhead_time << ")";
+        return difference.str();
+    }
+    for (size_t i = 0; i < actual.completion.size() && i < expected.completion.size(); i++)
+    {
+        if (expected.first_run[i] != actual.first_run[i] || expected.completion[i] != actual.completion[i])
+        {
+            difference << "pcb " << i << " (first run, completion) expected (" << expected.first_run[i] << ", " << expected.completion[i]
+                       << ") got (" << actual.first_run[i] << ", " << actual.completion[i] << ")";
+            return difference.str();
+        }
+    }
+    return difference.str();
+}
+
+// The checkpointable schedule state used for "what if" questions. The back half of the workload is held back as extra
+// arrivals and the rest is the base trace, which is advanced to the earliest extra arrival. A clone of it gets the extras
+// appended and is finished, which has to match the reference over the whole workload (the extras come after the base
+// pcbs, so ties go the same way). The original is then finished too and has to match the reference over the base
+// alone, or the engine fails, so a clone that shares state it shouldn't is caught as well.
+bool schedule_state_engine(oracle_algorithm_t algorithm, const oracle_workload_t &workload, oracle_outcome_t *outcome)
+{
+    std::vector<ProcessControlBlock_t> pcbs = to_pcbs(workload);
+    size_t split = pcbs.size() / 2;
+    uint64_t checkpoint = UINT64_MAX;
+    for (size_t i = split; i < pcbs.size(); i++)
+    {
+        checkpoint = std::min(checkpoint, pcbs[i].arrival);
+    }
+    ScheduleStateAlgorithm_t state_algorithm = algorithm == ORACLE_RR ? SCHEDULE_STATE_RR : SCHEDULE_STATE_FCFS;
+    schedule_state_t *base = schedule_state_create(pcbs.data(), split, state_algorithm, workload.quantum);
+    bool success = base != NULL && schedule_state_advance(base, checkpoint);
+    schedule_state_t *clone = success ? schedule_state_clone(base) : NULL;
+    success = clone != NULL && schedule_state_append(clone, pcbs.data() + split, pcbs.size() - split) &&
+              schedule_state_finish(clone, &outcome->result);
+    if (success && split > 0)
+    {
+        oracle_workload_t base_workload = workload;
+        base_workload.jobs.resize(split);
+        oracle_outcome_t base_outcome;
+        success = schedule_state_finish(base, &base_outcome.result) && compare_outcomes(reference_schedule(algorithm, base_workload), base_outcome).empty();
+    }
+    schedule_state_destroy(clone);
+    schedule_state_destroy(base);
+    return success;
+}
+
+// Runs one engine against the reference, empty if they agree
+std::string check_engine(const oracle_engine_t &engine, oracle_algorithm_t algorithm, const oracle_workload_t &workload)
+{
+    oracle_outcome_t actual;
+    if (!engine(algorithm, workload, &actual))
+    {
+        return "the engine failed";
+    }
+    return compare_outcomes(reference_schedule(algorithm, workload), actual);
+}
+
+// Shrinks a workload for as long as it keeps failing: drops pcbs, halves every burst or arrival at once (which keeps
+// ties intact), then makes the quantum and single bursts and arrivals smaller, until no step still fails
+oracle_workload_t shrink_workload(oracle_workload_t workload, const std::function<bool(const oracle_workload_t &)> &fails)
+{
+    bool shrunk = true;
+    while (shrunk)
+    {
+        shrunk = false;
+        for (size_t i = 0; i < workload.jobs.size() && workload.jobs.size() > 1; i++)
+        {
+            oracle_workload_t candidate = workload;
+            candidate.jobs.erase(candidate.jobs.begin() + (std::ptrdiff_t)i);
+            if (fails(candidate))
+            {
+                workload = candidate;
+                shrunk = true;
+                i--;
+            }
+        }
+        for (int field = 0; field < 2; field++)
+        {
+            oracle_workload_t candidate = workload;
+            bool changed = false;
+            for (oracle_job_t &job : candidate.jobs)
+            {
+                uint64_t &value = field ? job.arrival : job.burst;
+                changed = changed || value > 0;
+                value /= 2;
+            }
+            if (changed && fails(candidate))
+            {
+                workload = candidate;
+                shrunk = true;
+            }
+        }
+        for (size_t quantum : {(size_t)1, workload.quantum / 2, workload.quantum - 1})
+        {
+            oracle_workload_t candidate = workload;
+            candidate.quantum = quantum;
+            if (quantum >= 1 && quantum < workload.quantum && fails(candidate))
+            {
+                workload = candidate;
+                shrunk = true;
+            }
+        }
+        for (size_t i = 0; i < workload.jobs.size(); i++)
+        {
+            for (int field = 0; field < 2; field++)
+            {
+                uint64_t value = field ? workload.jobs[i].arrival : workload.jobs[i].burst;
+                for (uint64_t smaller : {(uint64_t)0, value / 2, value - 1})
+                {
+                    if (value == 0 || smaller >= value)
+                    {
+                        continue;
+                    }
+                    oracle_workload_t candidate = workload;
+                    (field ? candidate.jobs[i].arrival : candidate.jobs[i].burst) = smaller;
+                    if (fails(candidate))
+                    {
+                        workload = candidate;
+                        shrunk = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return workload;
+}
+
+std::string describe_workload(oracle_algorithm_t algorithm, const oracle_workload_t &workload)
+{
+    std::ostringstream description;
+    description << oracle_names[algorithm];
+    if (algorithm == ORACLE_RR)
+    {
+        description << " quantum " << workload.quantum;
+    }
+    description << ", {arrival, burst}:";
+    for (const oracle_job_t &job : workload.jobs)
+    {
+        description << " {" << job.arrival << ", " << job.burst << "}";
+    }
+    return description.str();
+}
+
+// Runs an engine over the seeded workloads for the given algorithms, reporting the first mismatch shrunk down
+void run_oracle(const char *engine_name, const oracle_engine_t &engine, const std::vector<oracle_algorithm_t> &algorithms)
+{
+    size_t iterations = oracle_env("HW2_ORACLE_ITERATIONS", ORACLE_DEFAULT_ITERATIONS);
+    uint64_t seed = oracle_env("HW2_ORACLE_SEED", ORACLE_DEFAULT_SEED);
+    uint64_t state = seed;
+    for (size_t iteration = 0; iteration < iterations; iteration++)
+    {
+        oracle_workload_t workload = random_workload(&state);
+        for (oracle_algorithm_t algorithm : algorithms)
+        {
+            if (check_engine(engine, algorithm, workload).empty())
+            {
+                continue;
+            }
+            oracle_workload_t minimal = shrink_workload(workload, [&](const oracle_workload_t &candidate) {
+                return !check_engine(engine, algorithm, candidate).empty();
+            });
+            ADD_FAILURE() << engine_name << " disagrees with the reference on workload " << iteration << " of seed " << seed
+                          << ", shrunk from " << workload.jobs.size() << " pcbs to " << describe_workload(algorithm, minimal) << ": "
+                          << check_engine(engine, algorithm, minimal);
+            return;
+        }
+    }
+}
+
+} // namespace
+
+TEST(schedule_oracle, ViewEnginesMatchReference)
+{
+    run_oracle("view scheduler", view_with_metrics, {ORACLE_FCFS, ORACLE_SJF, ORACLE_RR, ORACLE_SRTF});
+}
+
+TEST(schedule_oracle, DynArraySchedulersMatchReference)
+{
+    run_oracle("dyn_array scheduler", dyn_array_engine, {ORACLE_FCFS, ORACLE_SJF, ORACLE_RR, ORACLE_SRTF});
+}
+
+TEST(schedule_oracle, ScheduleStateMatchesReference)
+{
+    run_oracle("schedule state", schedule_state_engine, {ORACLE_FCFS, ORACLE_RR});
+}
+
+TEST(schedule_oracle, ShrinksMismatchToMinimalReproducer)
+{
+    // An engine that gets the run time wrong once any burst reaches 9 must shrink to one pcb with a burst of 9
+    oracle_engine_t broken = [](oracle_algorithm_t algorithm, const oracle_workload_t &workload, oracle_outcome_t *outcome) {
+        bool success = view_with_metrics(algorithm, workload, outcome);
+        for (const oracle_job_t &job : workload.jobs)
+        {
+            outcome->result.total_run_time += job.burst >= 9;
+        }
+        return success;
+    };
+    oracle_workload_t workload;
+    workload.quantum = 5;
+    workload.jobs = {{3, 2}, {0, 12}, {7, 4}, {7, 15}, {20, 1}};
+    ASSERT_FALSE(check_engine(broken, ORACLE_RR, workload).empty());
+    oracle_workload_t minimal = shrink_workload(workload, [&](const oracle_workload_t &candidate) {
+        return !check_engine(broken, ORACLE_RR, candidate).empty();
+    });
+    ASSERT_EQ((size_t)1, minimal.jobs.size());
+    EXPECT_EQ((uint64_t)0, minimal.jobs[0].arrival);
+    EXPECT_EQ((uint64_t)9, minimal.jobs[0].burst);
+    EXPECT_EQ((size_t)1, minimal.quantum);
+    EXPECT_EQ("RR quantum 1, {arrival, burst}: {0, 9}", describe_workload(ORACLE_RR, minimal));
+}
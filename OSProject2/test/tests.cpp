@@ -1,8 +1,19 @@
 #include <fcntl.h>
 #include <stdio.h>
+#include <algorithm>
+#include <vector>
 #include "gtest/gtest.h"
 #include <pthread.h>
+#include <unistd.h>
 #include "../include/processing_scheduling.h"
+#include "pcb_index.h"
+#include "pcb_reader.h"
+#include "perf_counters.h"
+#include "schedule_metrics.h"
+#include "alloc_stats.h"
+#include "schedule_timeline.h"
+#include "schedule_trace.h"
+#include "schedule_state.h"
 
 #include "utilities.h"
 
@@ -93,6 +104,378 @@ TEST(load_process_control_blocks, GoodFile1)
     dyn_array_destroy(array);
 }
 
+/*
+ * Load PCB in parallel
+ */
+TEST(load_process_control_blocks_parallel, BadFiles)
+{
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel(NULL, 4));
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel("test.bin", 4));
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel("../pcb_file_tests/files/count-only.bin", 4));
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel("../pcb_file_tests/files/no-arrival.bin", 4));
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel("../pcb_file_tests/files/no-priority.bin", 4));
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel("../pcb_file_tests/files/high-count.bin", 4));
+    dyn_array_t *array = load_process_control_blocks_parallel("../pcb_file_tests/files/low-count.bin", 4);
+    ASSERT_NE(nullptr, array);
+    EXPECT_EQ((size_t)1, array->size);
+    dyn_array_destroy(array);
+}
+
+TEST(load_process_control_blocks_parallel, MatchesSequentialLoad)
+{
+    // Large enough that the records are split between several threads
+    const char *path = "parallel-load-test.bin";
+    const uint32_t count = 100003;
+    FILE *fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    ASSERT_EQ((size_t)1, fwrite(&count, sizeof(uint32_t), 1, fp));
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t record[3] = {i % 97 + 1, i % 5, count - i}; // burst, priority, arrival
+        ASSERT_EQ((size_t)3, fwrite(record, sizeof(uint32_t), 3, fp));
+    }
+    fclose(fp);
+
+    dyn_array_t *expected = load_process_control_blocks(path);
+    ASSERT_NE(nullptr, expected);
+    for (size_t threads = 0; threads <= 8; threads += 3)
+    {
+        dyn_array_t *array = load_process_control_blocks_parallel(path, threads);
+        ASSERT_NE(nullptr, array);
+        ASSERT_EQ(expected->size, array->size);
+        for (size_t i = 0; i < expected->size; i++)
+        {
+            ProcessControlBlock_t *a = (ProcessControlBlock_t *)dyn_array_at(expected, i);
+            ProcessControlBlock_t *b = (ProcessControlBlock_t *)dyn_array_at(array, i);
+            ASSERT_EQ(a->arrival, b->arrival);
+            ASSERT_EQ(a->remaining_burst_time, b->remaining_burst_time);
+            ASSERT_EQ(a->total_burst_time, b->total_burst_time);
+            ASSERT_EQ(a->priority, b->priority);
+        }
+        dyn_array_destroy(array);
+    }
+    dyn_array_destroy(expected);
+
+    // Chopping off the last record must fail just like the high count file
+    ASSERT_EQ(0, truncate(path, sizeof(uint32_t) + (count - 1) * 3 * sizeof(uint32_t)));
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel(path, 4));
+    remove(path);
+}
+
+/*
+ * Load PCB with read-ahead
+ */
+TEST(load_process_control_blocks_prefetch, BadFiles)
+{
+    EXPECT_EQ(nullptr, load_process_control_blocks_prefetch(NULL, NULL));
+    EXPECT_EQ(nullptr, load_process_control_blocks_prefetch("test.bin", NULL));
+    EXPECT_EQ(nullptr, load_process_control_blocks_prefetch("../pcb_file_tests/files/count-only.bin", NULL));
+    EXPECT_EQ(nullptr, load_process_control_blocks_prefetch("../pcb_file_tests/files/no-arrival.bin", NULL));
+    EXPECT_EQ(nullptr, load_process_control_blocks_prefetch("../pcb_file_tests/files/high-count.bin", NULL));
+    dyn_array_t *array = load_process_control_blocks_prefetch("../pcb_file_tests/files/low-count.bin", NULL);
+    ASSERT_NE(nullptr, array);
+    EXPECT_EQ((size_t)1, array->size);
+    dyn_array_destroy(array);
+}
+
+TEST(first_come_first_serve_prefetch, SchedulesWhileReading)
+{
+    const char *path = "streamed-fcfs-test.bin";
+    uint32_t records[] = {4, 20, 0, 0, 5, 0, 1, 10, 0, 2, 15, 0, 3}; // count then burst, priority, arrival in arrival order
+    FILE *fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    ASSERT_EQ((size_t)13, fwrite(records, sizeof(uint32_t), 13, fp));
+    fclose(fp);
+    dyn_array_t *array = load_process_control_blocks(path);
+    ASSERT_NE(nullptr, array);
+    ScheduleResult_t expected;
+    ASSERT_TRUE(first_come_first_serve(array, &expected));
+
+    ScheduleResult_t sr;
+    size_t process_count = 0;
+    uint64_t content_hash = 0;
+    bool unsorted = true;
+    ASSERT_TRUE(first_come_first_serve_prefetch(path, &sr, &process_count, &content_hash, &unsorted, NULL));
+    EXPECT_FALSE(unsorted);
+    EXPECT_EQ((size_t)4, process_count);
+    EXPECT_EQ(pcb_content_hash((const ProcessControlBlock_t *)dyn_array_export(array), 4), content_hash);
+    EXPECT_DOUBLE_EQ(expected.average_waiting_time, sr.average_waiting_time);
+    EXPECT_DOUBLE_EQ(expected.average_turnaround_time, sr.average_turnaround_time);
+    EXPECT_DOUBLE_EQ(expected.average_response_time, sr.average_response_time);
+    EXPECT_EQ(expected.total_run_time, sr.total_run_time);
+    EXPECT_EQ(expected.context_switches, sr.context_switches);
+    dyn_array_destroy(array);
+
+    // A pcb arriving before the one ahead of it means the file has to be loaded and sorted instead
+    records[12] = 1;
+    fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    ASSERT_EQ((size_t)13, fwrite(records, sizeof(uint32_t), 13, fp));
+    fclose(fp);
+    EXPECT_FALSE(first_come_first_serve_prefetch(path, &sr, &process_count, NULL, &unsorted, NULL));
+    EXPECT_TRUE(unsorted);
+    PcbReaderStats_t stats;
+    EXPECT_FALSE(first_come_first_serve_prefetch("test.bin", &sr, &process_count, NULL, &unsorted, &stats));
+    EXPECT_FALSE(unsorted);
+    EXPECT_EQ((uint64_t)0, stats.buffers);
+    remove(path);
+}
+
+TEST(load_process_control_blocks_prefetch, ReaderSwapsBuffers)
+{
+    dyn_array_t *expected = load_process_control_blocks("../pcb.bin");
+    ASSERT_NE(nullptr, expected);
+    // One record per buffer so every read hands a buffer back to the background thread
+    pcb_reader_t *reader = pcb_reader_open("../pcb.bin", 1);
+    ASSERT_NE(nullptr, reader);
+    ASSERT_EQ((uint32_t)expected->size, pcb_reader_count(reader));
+    ProcessControlBlock_t pcbs[8];
+    EXPECT_EQ((size_t)3, pcb_reader_read(reader, pcbs, 3));
+    EXPECT_EQ((size_t)1, pcb_reader_read(reader, pcbs + 3, 5));
+    EXPECT_EQ((size_t)0, pcb_reader_read(reader, pcbs + 4, 4));
+    EXPECT_FALSE(pcb_reader_failed(reader));
+    PcbReaderStats_t stats;
+    pcb_reader_close(reader, &stats);
+    EXPECT_EQ((uint64_t)4, stats.buffers);
+    EXPECT_EQ((uint64_t)48, stats.bytes_read);
+    for (size_t i = 0; i < expected->size; i++)
+    {
+        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(expected, i);
+        EXPECT_EQ(pcb->arrival, pcbs[i].arrival);
+        EXPECT_EQ(pcb->remaining_burst_time, pcbs[i].remaining_burst_time);
+        EXPECT_EQ(pcb->priority, pcbs[i].priority);
+    }
+    dyn_array_destroy(expected);
+}
+
+/*
+ * Load PCB through the sorted index sidecar
+ */
+TEST(load_process_control_blocks_indexed, BuildsReusesAndRebuildsIndex)
+{
+    const char *path = "indexed-load-test.bin";
+    uint32_t records[] = {4, 20, 0, 3, 5, 0, 2, 10, 0, 1, 15, 0, 0}; // count then burst, priority, arrival
+    FILE *fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    ASSERT_EQ((size_t)13, fwrite(records, sizeof(uint32_t), 13, fp));
+    fclose(fp);
+    char *index_path = pcb_index_path(path);
+    ASSERT_NE(nullptr, index_path);
+    remove(index_path);
+
+    bool rebuilt = false;
+    dyn_array_t *array = load_process_control_blocks_indexed(path, PCB_ORDER_ARRIVAL, &rebuilt, NULL);
+    ASSERT_NE(nullptr, array);
+    EXPECT_TRUE(rebuilt);
+    EXPECT_TRUE(dyn_array_is_sorted(array, compare_arrival));
+    ScheduleResult_t sr;
+    EXPECT_TRUE(first_come_first_serve(array, &sr));
+    EXPECT_NEAR((float)16, sr.average_waiting_time, .01);
+    dyn_array_destroy(array);
+
+    // Second load hits the sidecar written by the first
+    // The content hash is of the file order, not the order the pcbs come back in
+    dyn_array_t *file_order = load_process_control_blocks(path);
+    ASSERT_NE(nullptr, file_order);
+    uint64_t content_hash = 0;
+    array = load_process_control_blocks_indexed(path, PCB_ORDER_ARRIVAL_BURST, &rebuilt, &content_hash);
+    ASSERT_NE(nullptr, array);
+    EXPECT_FALSE(rebuilt);
+    EXPECT_EQ(pcb_content_hash((const ProcessControlBlock_t *)dyn_array_export(file_order), dyn_array_size(file_order)), content_hash);
+    dyn_array_destroy(file_order);
+    EXPECT_TRUE(dyn_array_is_sorted(array, compare_arrival_burst));
+    EXPECT_TRUE(shortest_remaining_time_first(array, &sr));
+    EXPECT_NEAR((float)11.75, sr.average_waiting_time, .01);
+    dyn_array_destroy(array);
+
+    // Changing the file makes the index stale
+    records[2] = 7;
+    fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    ASSERT_EQ((size_t)13, fwrite(records, sizeof(uint32_t), 13, fp));
+    fclose(fp);
+    array = load_process_control_blocks_indexed(path, PCB_ORDER_ARRIVAL, &rebuilt, NULL);
+    ASSERT_NE(nullptr, array);
+    EXPECT_TRUE(rebuilt);
+    EXPECT_EQ((uint32_t)7, ((ProcessControlBlock_t *)dyn_array_back(array))->priority);
+    dyn_array_destroy(array);
+
+    EXPECT_EQ(nullptr, load_process_control_blocks_indexed("../pcb_file_tests/files/high-count.bin", PCB_ORDER_ARRIVAL, NULL, NULL));
+    remove(path);
+    remove(index_path);
+    free(index_path);
+}
+
+TEST(load_process_control_blocks, Pcb64Layout)
+{
+    const char *path = "pcb64.bin";
+    FILE *fp = fopen(path, "wb");
+    ASSERT_NE(nullptr, fp);
+    const uint64_t big = (uint64_t)1 << 40;
+    uint64_t header = 3;
+    uint64_t records[] = {big, 1, 0, 5, 2, big + 7, 1, 3, 9}; // burst, priority, arrival
+    ASSERT_EQ((size_t)PCB64_MAGIC_SIZE, fwrite(PCB64_MAGIC, 1, PCB64_MAGIC_SIZE, fp));
+    ASSERT_EQ((size_t)1, fwrite(&header, sizeof(uint64_t), 1, fp));
+    ASSERT_EQ((size_t)9, fwrite(records, sizeof(uint64_t), 9, fp));
+    fclose(fp);
+
+    dyn_array_t *arrays[] = {load_process_control_blocks(path), load_process_control_blocks_parallel(path, 2),
+                             load_process_control_blocks_prefetch(path, NULL)};
+    for (dyn_array_t *array : arrays)
+    {
+        ASSERT_NE(nullptr, array);
+        ASSERT_EQ((size_t)3, dyn_array_size(array));
+        ProcessControlBlock_t *pcbs = (ProcessControlBlock_t *)dyn_array_export(array);
+        EXPECT_EQ(big, pcbs[0].remaining_burst_time);
+        EXPECT_EQ(big, pcbs[0].total_burst_time);
+        EXPECT_EQ(big + 7, pcbs[1].arrival);
+        EXPECT_EQ((uint32_t)2, pcbs[1].priority);
+        EXPECT_EQ((uint64_t)9, pcbs[2].arrival);
+        dyn_array_destroy(array);
+    }
+
+    // Priorities stay 32 bit
+    fp = fopen(path, "r+b");
+    ASSERT_NE(nullptr, fp);
+    uint64_t priority = (uint64_t)1 << 32;
+    ASSERT_EQ(0, fseek(fp, PCB64_MAGIC_SIZE + sizeof(uint64_t) * 2, SEEK_SET));
+    ASSERT_EQ((size_t)1, fwrite(&priority, sizeof(uint64_t), 1, fp));
+    fclose(fp);
+    EXPECT_EQ(nullptr, load_process_control_blocks(path));
+    EXPECT_EQ(nullptr, load_process_control_blocks_parallel(path, 2));
+    EXPECT_EQ(nullptr, load_process_control_blocks_prefetch(path, NULL));
+    remove(path);
+}
+
+TEST(pcb_file_layout, MagicNeedsMatchingSize)
+{
+    uint8_t header[PCB_FILE_HEADER_MAX];
+    uint64_t pcb64_count = 3;
+    memcpy(header, PCB64_MAGIC, PCB64_MAGIC_SIZE);
+    memcpy(header + PCB64_MAGIC_SIZE, &pcb64_count, sizeof(uint64_t));
+    PcbFileLayout_t layout;
+
+    ASSERT_TRUE(pcb_file_layout(header, sizeof(header), PCB64_MAGIC_SIZE + sizeof(uint64_t) * 10, &layout));
+    EXPECT_EQ((uint64_t)3, layout.pcb_count);
+    EXPECT_EQ((size_t)PCB64_MAGIC_SIZE + sizeof(uint64_t), layout.header_size);
+    EXPECT_EQ(sizeof(uint64_t), layout.field_size);
+
+    // The same bytes at the start of an original layout file that claims the "PCB6" count of pcbs
+    uint32_t original_count;
+    memcpy(&original_count, header, sizeof(uint32_t));
+    ASSERT_TRUE(pcb_file_layout(header, sizeof(header), sizeof(uint32_t) + (uint64_t)original_count * 3 * sizeof(uint32_t), &layout));
+    EXPECT_EQ((uint64_t)original_count, layout.pcb_count);
+    EXPECT_EQ(sizeof(uint32_t), layout.header_size);
+    EXPECT_EQ(sizeof(uint32_t), layout.field_size);
+
+    EXPECT_FALSE(pcb_file_layout(header, 2, 2, &layout));
+    EXPECT_FALSE(pcb_file_layout(NULL, sizeof(header), sizeof(header), &layout));
+}
+
+/*
+ * Load PCB CSV
+ */
+TEST(load_process_control_blocks_csv, NullFilename)
+{
+    size_t error_line = 1;
+    EXPECT_EQ(nullptr, load_process_control_blocks_csv(NULL, &error_line));
+    EXPECT_EQ((size_t)0, error_line);
+}
+
+TEST(load_process_control_blocks_csv, MatchesBinaryFile)
+{
+    dyn_array_t *csv = load_process_control_blocks_csv("../pcb_file_tests/files/valid-pcb.csv", NULL);
+    dyn_array_t *tsv = load_process_control_blocks_csv("../pcb_file_tests/files/valid-pcb.tsv", NULL);
+    dyn_array_t *binary = load_process_control_blocks("../pcb.bin");
+    ASSERT_NE(nullptr, csv);
+    ASSERT_NE(nullptr, tsv);
+    ASSERT_NE(nullptr, binary);
+    ASSERT_EQ(binary->size, csv->size);
+    ASSERT_EQ(binary->size, tsv->size);
+    for (size_t i = 0; i < binary->size; i++)
+    {
+        ProcessControlBlock_t *expected = (ProcessControlBlock_t *)dyn_array_at(binary, i);
+        ProcessControlBlock_t *pcbs[] = {(ProcessControlBlock_t *)dyn_array_at(csv, i), (ProcessControlBlock_t *)dyn_array_at(tsv, i)};
+        for (ProcessControlBlock_t *pcb : pcbs)
+        {
+            EXPECT_EQ(expected->arrival, pcb->arrival);
+            EXPECT_EQ(expected->remaining_burst_time, pcb->remaining_burst_time);
+            EXPECT_EQ(expected->total_burst_time, pcb->total_burst_time);
+            EXPECT_EQ(expected->priority, pcb->priority);
+        }
+    }
+    dyn_array_destroy(csv);
+    dyn_array_destroy(tsv);
+    dyn_array_destroy(binary);
+}
+
+TEST(load_process_control_blocks_csv, BadLineReported)
+{
+    size_t error_line = 0;
+    EXPECT_EQ(nullptr, load_process_control_blocks_csv("../pcb_file_tests/files/bad-line.csv", &error_line));
+    EXPECT_EQ((size_t)3, error_line);
+
+    // An empty tsv field is an error, not skipped over to the next field
+    const char *input = "empty-field.tsv";
+    FILE *fp = fopen(input, "w");
+    ASSERT_NE(nullptr, fp);
+    fputs("0\t4\t1\n1\t\t2\t3\n", fp);
+    fclose(fp);
+    error_line = 0;
+    EXPECT_EQ(nullptr, load_process_control_blocks_csv(input, &error_line));
+    EXPECT_EQ((size_t)2, error_line);
+    remove(input);
+}
+
+TEST(load_process_control_blocks_csv, TranscodeToBinary)
+{
+    const char *output = "transcoded-pcb.bin";
+    EXPECT_TRUE(transcode_pcb_csv_to_binary("../pcb_file_tests/files/valid-pcb.csv", output, NULL));
+    dyn_array_t *array = load_process_control_blocks(output);
+    ASSERT_NE(nullptr, array);
+    ScheduleResult_t sr;
+    EXPECT_EQ(true, first_come_first_serve(array, &sr));
+    EXPECT_NEAR((float)16, sr.average_waiting_time, .01);
+    EXPECT_NEAR((float)28.5, sr.average_turnaround_time, .01);
+    dyn_array_destroy(array);
+    remove(output);
+
+    size_t error_line = 0;
+    EXPECT_FALSE(transcode_pcb_csv_to_binary("../pcb_file_tests/files/bad-line.csv", output, &error_line));
+    EXPECT_EQ((size_t)3, error_line);
+    EXPECT_EQ(nullptr, fopen(output, "r"));
+}
+
+TEST(load_process_control_blocks_csv, TranscodesWideValuesToPcb64)
+{
+    const char *input = "wide-pcb.csv";
+    const char *output = "wide-pcb.bin";
+    FILE *fp = fopen(input, "w");
+    ASSERT_NE(nullptr, fp);
+    fputs("arrival,burst,priority\n0,4,1\n5000000000,18446744073709551615,4294967295\n", fp);
+    fclose(fp);
+    ASSERT_TRUE(transcode_pcb_csv_to_binary(input, output, NULL));
+    dyn_array_t *array = load_process_control_blocks(output);
+    ASSERT_NE(nullptr, array);
+    ASSERT_EQ((size_t)2, dyn_array_size(array));
+    ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(array, 1);
+    EXPECT_EQ((uint64_t)5000000000ULL, pcb->arrival);
+    EXPECT_EQ(UINT64_MAX, pcb->remaining_burst_time);
+    EXPECT_EQ(UINT32_MAX, pcb->priority);
+    dyn_array_destroy(array);
+    remove(output);
+
+    // Priorities still have to fit 32 bits
+    fp = fopen(input, "w");
+    ASSERT_NE(nullptr, fp);
+    fputs("0,4,1\n1,2,4294967296\n", fp);
+    fclose(fp);
+    size_t error_line = 0;
+    EXPECT_EQ(nullptr, load_process_control_blocks_csv(input, &error_line));
+    EXPECT_EQ((size_t)2, error_line);
+    remove(input);
+}
+
 /*
  * Shortest Remaining Time First
  */
@@ -443,6 +826,964 @@ TEST(round_robin, SuccessfulRunFile)
     dyn_array_destroy(array);
 }
 
+TEST(round_robin, IdleUntilNextArrival)
+{
+    // The first process finishes inside its quantum before the second arrives, the second must still run
+    ProcessControlBlock_t pcbs[2];
+    create_pcb(0, 1, 2, false, &pcbs[0]);
+    create_pcb(10, 1, 3, false, &pcbs[1]);
+    dyn_array_t *ready_queue = dyn_array_import(pcbs, 2, sizeof(ProcessControlBlock_t), NULL);
+    ScheduleResult_t result;
+    EXPECT_TRUE(round_robin(ready_queue, &result, 5));
+    EXPECT_EQ(0, result.average_waiting_time);
+    EXPECT_EQ((float)2.5, result.average_turnaround_time);
+    EXPECT_EQ((unsigned long)13, result.total_run_time);
+    dyn_array_destroy(ready_queue);
+}
+
+TEST(schedule_view, SharesInputAndScratch)
+{
+    dyn_array_t *array = load_process_control_blocks("../pcb.bin");
+    ASSERT_NE(nullptr, array);
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *)dyn_array_export(array);
+    size_t count = dyn_array_size(array);
+    ProcessControlBlock_t *before = (ProcessControlBlock_t *)malloc(sizeof(ProcessControlBlock_t) * count);
+    memcpy(before, pcbs, sizeof(ProcessControlBlock_t) * count);
+
+    size_t scratch_size = schedule_scratch_size(count);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+
+    // Every view scheduler runs over the same pcbs with the same scratch and matches the dyn_array wrapper
+    ScheduleResult_t expected, actual;
+    ASSERT_TRUE(first_come_first_serve(array, &expected));
+    ASSERT_TRUE(first_come_first_serve_view(pcbs, count, &actual, &context));
+    EXPECT_EQ(expected.average_waiting_time, actual.average_waiting_time);
+    EXPECT_EQ(expected.total_run_time, actual.total_run_time);
+    ASSERT_TRUE(shortest_job_first(array, &expected));
+    ASSERT_TRUE(shortest_job_first_view(pcbs, count, &actual, &context));
+    EXPECT_EQ(expected.average_waiting_time, actual.average_waiting_time);
+    EXPECT_NEAR(14.75, actual.average_waiting_time, .01);
+    ASSERT_TRUE(round_robin(array, &expected, 5));
+    ASSERT_TRUE(round_robin_view(pcbs, count, &actual, 5, &context));
+    EXPECT_EQ(expected.average_turnaround_time, actual.average_turnaround_time);
+    EXPECT_NEAR(32.25, actual.average_turnaround_time, .01);
+    ASSERT_TRUE(shortest_remaining_time_first(array, &expected));
+    ASSERT_TRUE(shortest_remaining_time_first_view(pcbs, count, &actual, &context));
+    EXPECT_EQ(expected.average_waiting_time, actual.average_waiting_time);
+    EXPECT_EQ((unsigned long)50, actual.total_run_time);
+
+    // Neither the views nor the wrappers reorder or consume the pcbs
+    ASSERT_EQ(count, dyn_array_size(array));
+    EXPECT_EQ(0, memcmp(before, pcbs, sizeof(ProcessControlBlock_t) * count));
+
+    // Too little scratch, no scratch, no pcbs or no quantum are errors
+    ScheduleContext_t small;
+    schedule_context_init(&small, scratch, scratch_size - 1);
+    EXPECT_FALSE(first_come_first_serve_view(pcbs, count, &actual, &small));
+    schedule_context_init(&small, NULL, scratch_size);
+    EXPECT_FALSE(shortest_job_first_view(pcbs, count, &actual, &small));
+    EXPECT_FALSE(shortest_remaining_time_first_view(NULL, count, &actual, &context));
+    EXPECT_FALSE(shortest_remaining_time_first_view(pcbs, 0, &actual, &context));
+    EXPECT_FALSE(round_robin_view(pcbs, count, &actual, 0, &context));
+    EXPECT_FALSE(round_robin_view(pcbs, count, NULL, 1, &context));
+
+    free(scratch);
+    free(before);
+    dyn_array_destroy(array);
+}
+
+TEST(schedule_view, PerPcbMetricsMatchAverages)
+{
+    dyn_array_t *array = load_process_control_blocks("../pcb.bin");
+    ASSERT_NE(nullptr, array);
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *)dyn_array_export(array);
+    size_t count = dyn_array_size(array);
+    size_t scratch_size = schedule_scratch_size(count);
+    void *scratch = malloc(scratch_size);
+    PcbMetrics_t *metrics = (PcbMetrics_t *)malloc(sizeof(PcbMetrics_t) * count);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    context.metrics = metrics;
+
+    const char *algorithms[] = {"FCFS", "SJF", "RR", "SRTF"};
+    for (const char *algorithm : algorithms)
+    {
+        ScheduleResult_t result;
+        ASSERT_TRUE(run_schedule_view(algorithm, pcbs, count, &result, 3, &context));
+        uint64_t total_waiting = 0, total_turnaround = 0, total_response = 0, last_completion = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            total_waiting += metrics[i].waiting;
+            total_turnaround += metrics[i].turnaround;
+            total_response += metrics[i].response;
+            last_completion = std::max(last_completion, metrics[i].completion);
+            EXPECT_EQ(metrics[i].first_run - pcbs[i].arrival, metrics[i].response);
+            EXPECT_LE(metrics[i].response, metrics[i].waiting);
+            EXPECT_EQ(metrics[i].completion - pcbs[i].arrival, metrics[i].turnaround);
+        }
+        EXPECT_DOUBLE_EQ(result.average_waiting_time, (double)total_waiting / count) << algorithm;
+        EXPECT_DOUBLE_EQ(result.average_turnaround_time, (double)total_turnaround / count) << algorithm;
+        EXPECT_DOUBLE_EQ(result.average_response_time, (double)total_response / count) << algorithm;
+        EXPECT_EQ(result.total_run_time, last_completion) << algorithm;
+    }
+    // Non preemptive schedulers run every pcb as soon as it first gets the cpu, so response and waiting are the same
+    ScheduleResult_t result;
+    ASSERT_TRUE(shortest_job_first_view(pcbs, count, &result, &context));
+    for (size_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(metrics[i].waiting, metrics[i].response);
+    }
+    free(metrics);
+    free(scratch);
+    dyn_array_destroy(array);
+}
+
+TEST(schedule_view, ResponseTimeAndContextSwitches)
+{
+    ProcessControlBlock_t pcbs[3];
+    create_pcb(0, 1, 5, false, &pcbs[0]);
+    create_pcb(1, 1, 2, false, &pcbs[1]);
+    create_pcb(2, 1, 3, false, &pcbs[2]);
+    size_t scratch_size = schedule_scratch_size(3);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    ScheduleResult_t result;
+
+    // 0-5 A, 5-7 B, 7-10 C
+    ASSERT_TRUE(first_come_first_serve_view(pcbs, 3, &result, &context));
+    EXPECT_DOUBLE_EQ(3.0, result.average_response_time);
+    EXPECT_EQ((unsigned long)2, result.context_switches);
+    ASSERT_TRUE(shortest_job_first_view(pcbs, 3, &result, &context));
+    EXPECT_DOUBLE_EQ(3.0, result.average_response_time);
+    EXPECT_EQ((unsigned long)2, result.context_switches);
+
+    // 0-1 A, 1-3 B, 3-6 C, 6-10 A
+    ASSERT_TRUE(shortest_remaining_time_first_view(pcbs, 3, &result, &context));
+    EXPECT_DOUBLE_EQ((double)1 / 3, result.average_response_time);
+    EXPECT_EQ((unsigned long)3, result.context_switches);
+
+    // 0-2 A, 2-4 B, 4-6 C, 6-8 A, 8-9 C, 9-10 A
+    ASSERT_TRUE(round_robin_view(pcbs, 3, &result, 2, &context));
+    EXPECT_DOUBLE_EQ(1.0, result.average_response_time);
+    EXPECT_EQ((unsigned long)5, result.context_switches);
+
+    // A pcb that keeps the cpu across quanta isn't switched away from
+    ASSERT_TRUE(round_robin_view(pcbs, 1, &result, 1, &context));
+    EXPECT_EQ((unsigned long)0, result.context_switches);
+    free(scratch);
+}
+
+TEST(schedule_view, SwitchCostModel)
+{
+    ProcessControlBlock_t pcbs[3];
+    create_pcb(0, 1, 5, false, &pcbs[0]);
+    create_pcb(1, 1, 2, false, &pcbs[1]);
+    create_pcb(2, 1, 3, false, &pcbs[2]);
+    size_t scratch_size = schedule_scratch_size(3);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    ScheduleResult_t result;
+
+    // 0-5 A, 5-6 switch, 6-8 B, 8-9 switch, 9-12 C
+    context.cost.switch_cost = 1;
+    ASSERT_TRUE(first_come_first_serve_view(pcbs, 3, &result, &context));
+    EXPECT_EQ((unsigned long)2, result.overhead_time);
+    EXPECT_EQ((unsigned long)12, result.total_run_time);
+    EXPECT_DOUBLE_EQ(4.0, result.average_waiting_time);
+    EXPECT_DOUBLE_EQ(4.0, result.average_response_time);
+
+    // 0-1 A, 1-2 switch, 2-4 B (C arrives during the switch and waits), 4-5 switch, 5-8 C, 8-9 switch, 9-13 A
+    ASSERT_TRUE(shortest_remaining_time_first_view(pcbs, 3, &result, &context));
+    EXPECT_EQ((unsigned long)3, result.overhead_time);
+    EXPECT_EQ((unsigned long)13, result.total_run_time);
+    EXPECT_EQ((unsigned long)3, result.context_switches);
+
+    // The cold cache penalty only charges a pcb that ran recently for the part of the window it was away for:
+    // 0-2 A, +4 cold B, 6-8 B, +4 cold C, 12-14 C, +4 A away 12, 18-20 A, +3 C away 6, 23-24 C, +2 A away 4, 26-27 A
+    context.cost.switch_cost = 0;
+    context.cost.cold_cache_penalty = 4;
+    context.cost.cold_cache_window = 8;
+    ASSERT_TRUE(round_robin_view(pcbs, 3, &result, 2, &context));
+    EXPECT_EQ((unsigned long)17, result.overhead_time);
+    EXPECT_EQ((unsigned long)27, result.total_run_time);
+    EXPECT_EQ((unsigned long)5, result.context_switches);
+
+    // Switching is free without a cost model
+    schedule_context_init(&context, scratch, scratch_size);
+    ASSERT_TRUE(round_robin_view(pcbs, 3, &result, 2, &context));
+    EXPECT_EQ((unsigned long)0, result.overhead_time);
+    EXPECT_EQ((unsigned long)10, result.total_run_time);
+    free(scratch);
+}
+
+// Flush callback for the trace tests, collects the events into a std::vector
+static void collect_events(const ScheduleEvent_t *events, size_t count, void *arg)
+{
+    std::vector<ScheduleEvent_t> *collected = (std::vector<ScheduleEvent_t> *)arg;
+    collected->insert(collected->end(), events, events + count);
+}
+
+TEST(schedule_trace, RecordsRoundRobinEvents)
+{
+    ProcessControlBlock_t pcbs[3];
+    create_pcb(0, 1, 5, false, &pcbs[0]);
+    create_pcb(1, 1, 2, false, &pcbs[1]);
+    create_pcb(2, 1, 3, false, &pcbs[2]);
+    size_t scratch_size = schedule_scratch_size(3);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    ScheduleResult_t result;
+
+    // A ring of 4 overflows several times, every event still reaches the callback in order
+    std::vector<ScheduleEvent_t> events;
+    context.trace = schedule_trace_create(3, collect_events, &events);
+    ASSERT_NE(nullptr, context.trace);
+    ASSERT_TRUE(round_robin_view(pcbs, 3, &result, 2, &context));
+    ASSERT_TRUE(schedule_trace_flush(context.trace));
+    // 0-2 A, 2-4 B, 4-6 C, 6-8 A, 8-9 C, 9-10 A
+    const ScheduleEvent_t expected[] = {
+        {0, 0, SCHEDULE_EVENT_ARRIVE}, {0, 0, SCHEDULE_EVENT_DISPATCH}, {1, 1, SCHEDULE_EVENT_ARRIVE}, {2, 2, SCHEDULE_EVENT_ARRIVE},
+        {2, 0, SCHEDULE_EVENT_PREEMPT}, {2, 1, SCHEDULE_EVENT_DISPATCH}, {4, 1, SCHEDULE_EVENT_COMPLETE}, {4, 2, SCHEDULE_EVENT_DISPATCH},
+        {6, 2, SCHEDULE_EVENT_PREEMPT}, {6, 0, SCHEDULE_EVENT_DISPATCH}, {8, 0, SCHEDULE_EVENT_PREEMPT}, {8, 2, SCHEDULE_EVENT_DISPATCH},
+        {9, 2, SCHEDULE_EVENT_COMPLETE}, {9, 0, SCHEDULE_EVENT_DISPATCH}, {10, 0, SCHEDULE_EVENT_COMPLETE},
+    };
+    const size_t expected_count = sizeof(expected) / sizeof(expected[0]);
+    ASSERT_EQ(expected_count, events.size());
+    for (size_t i = 0; i < expected_count; i++)
+    {
+        EXPECT_EQ(expected[i].time, events[i].time) << i;
+        EXPECT_EQ(expected[i].pid, events[i].pid) << i;
+        EXPECT_EQ(expected[i].type, events[i].type) << i;
+    }
+    schedule_trace_destroy(context.trace);
+
+    // Without a callback the ring keeps the most recent events
+    context.trace = schedule_trace_create(4, NULL, NULL);
+    ASSERT_TRUE(round_robin_view(pcbs, 3, &result, 2, &context));
+    EXPECT_FALSE(schedule_trace_flush(context.trace));
+    EXPECT_EQ((uint64_t)(expected_count - 4), context.trace->dropped);
+    ScheduleEvent_t drained[8];
+    ASSERT_EQ((size_t)4, schedule_trace_drain(context.trace, drained, 8));
+    EXPECT_EQ(expected[expected_count - 4].time, drained[0].time);
+    EXPECT_EQ((uint32_t)SCHEDULE_EVENT_COMPLETE, drained[3].type);
+    EXPECT_EQ((size_t)0, schedule_trace_drain(context.trace, drained, 8));
+    schedule_trace_destroy(context.trace);
+
+    // Every algorithm traces each arrival and completion once and a dispatch per switch
+    const char *algorithms[] = {"FCFS", "SJF", "RR", "SRTF"};
+    for (const char *algorithm : algorithms)
+    {
+        events.clear();
+        context.trace = schedule_trace_create(64, collect_events, &events);
+        ASSERT_TRUE(run_schedule_view(algorithm, pcbs, 3, &result, 2, &context));
+        ASSERT_TRUE(schedule_trace_flush(context.trace));
+        size_t counts[4] = {0, 0, 0, 0};
+        for (const ScheduleEvent_t &event : events)
+        {
+            counts[event.type]++;
+        }
+        EXPECT_EQ((size_t)3, counts[SCHEDULE_EVENT_ARRIVE]) << algorithm;
+        EXPECT_EQ((size_t)3, counts[SCHEDULE_EVENT_COMPLETE]) << algorithm;
+        EXPECT_EQ(result.context_switches + 1, counts[SCHEDULE_EVENT_DISPATCH]) << algorithm;
+        schedule_trace_destroy(context.trace);
+    }
+    free(scratch);
+}
+
+// Phase callback for the tests, appends every phase it is told about
+static void collect_phases(SchedulePhase_t phase, void *arg)
+{
+    ((std::vector<SchedulePhase_t> *)arg)->push_back(phase);
+}
+
+TEST(schedule_view, ReportsPhases)
+{
+    ProcessControlBlock_t pcbs[2];
+    create_pcb(3, 1, 2, false, &pcbs[0]);
+    create_pcb(0, 1, 4, false, &pcbs[1]);
+    size_t scratch_size = schedule_scratch_size(2);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    std::vector<SchedulePhase_t> phases;
+    context.phase = collect_phases;
+    context.phase_arg = &phases;
+    ScheduleResult_t result;
+    const char *algorithms[] = {"FCFS", "SJF", "RR", "SRTF"};
+    for (const char *algorithm : algorithms)
+    {
+        phases.clear();
+        ASSERT_TRUE(run_schedule_view(algorithm, pcbs, 2, &result, 2, &context));
+        ASSERT_EQ((size_t)3, phases.size()) << algorithm;
+        EXPECT_EQ(SCHEDULE_PHASE_SORT, phases[0]);
+        EXPECT_EQ(SCHEDULE_PHASE_RUN, phases[1]);
+        EXPECT_EQ(SCHEDULE_PHASE_DONE, phases[2]);
+    }
+    free(scratch);
+}
+
+TEST(perf_counters, DegradesWhenUnavailable)
+{
+    // Whether counters can be opened depends on the machine, either way the calls are safe and the counters that
+    // couldn't be opened read as unavailable
+    PerfCounters_t counters;
+    bool any = perf_counters_open(&counters);
+    PerfCounterValues_t values;
+    perf_counters_start(&counters);
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < 100000; i++)
+    {
+        sum += i;
+    }
+    perf_counters_stop(&counters, &values);
+    bool any_valid = false;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        if (counters.fds[i] < 0)
+        {
+            EXPECT_FALSE(values.valid[i]);
+            EXPECT_EQ((uint64_t)0, values.values[i]);
+        }
+        any_valid = any_valid || values.valid[i];
+    }
+    EXPECT_TRUE(any || !any_valid);
+    perf_counters_close(&counters);
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        EXPECT_EQ(-1, counters.fds[i]);
+    }
+    EXPECT_STREQ("branch-misses", perf_counter_name(PERF_COUNTER_BRANCH_MISSES));
+}
+
+TEST(schedule_view, ExactAtLargeTimes)
+{
+    // Totals past 2^32 and averages past 2^24, where 32 bit accumulators wrap and floats round
+    const size_t count = 3;
+    const uint64_t burst = ((uint64_t)1 << 33) + 1;
+    ProcessControlBlock_t pcbs[count];
+    for (size_t i = 0; i < count; i++)
+    {
+        create_pcb(0, 0, burst, false, &pcbs[i]);
+    }
+    size_t scratch_size = schedule_scratch_size(count);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    const char *algorithms[] = {"FCFS", "SJF", "RR", "SRTF"};
+    for (const char *algorithm : algorithms)
+    {
+        ScheduleResult_t result;
+        ASSERT_TRUE(run_schedule_view(algorithm, pcbs, count, &result, burst, &context));
+        EXPECT_EQ(3 * burst, result.total_run_time) << algorithm;
+        EXPECT_DOUBLE_EQ((double)burst, result.average_waiting_time) << algorithm;
+        EXPECT_DOUBLE_EQ((double)(2 * burst), result.average_turnaround_time) << algorithm;
+    }
+    free(scratch);
+}
+
+TEST(schedule_state, MatchesViewAfterAppends)
+{
+    // Base and extra pcbs from a fixed LCG, the extras arrive at or after the checkpoint
+    uint64_t seed = 12345;
+    auto next = [&seed](uint64_t bound) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (seed >> 33) % bound;
+    };
+    const size_t base_count = 40;
+    const size_t extra_count = 10;
+    ProcessControlBlock_t pcbs[base_count + extra_count];
+    size_t scratch_size = schedule_scratch_size(base_count + extra_count);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    for (int round = 0; round < 200; round++)
+    {
+        for (size_t i = 0; i < base_count; i++)
+        {
+            create_pcb(next(100), 0, next(12) + 1, false, &pcbs[i]);
+        }
+        uint64_t checkpoint = next(150);
+        for (size_t i = base_count; i < base_count + extra_count; i++)
+        {
+            create_pcb(checkpoint + next(30), 0, next(12) + 1, false, &pcbs[i]);
+        }
+        size_t quantum = next(6) + 1;
+        for (ScheduleStateAlgorithm_t algorithm : {SCHEDULE_STATE_FCFS, SCHEDULE_STATE_RR})
+        {
+            ScheduleResult_t expected;
+            ASSERT_TRUE(algorithm == SCHEDULE_STATE_FCFS
+                            ? first_come_first_serve_view(pcbs, base_count + extra_count, &expected, &context)
+                            : round_robin_view(pcbs, base_count + extra_count, &expected, quantum, &context));
+
+            schedule_state_t *base = schedule_state_create(pcbs, base_count, algorithm, quantum);
+            ASSERT_NE(nullptr, base);
+            ASSERT_TRUE(schedule_state_advance(base, checkpoint));
+            EXPECT_EQ(checkpoint, schedule_state_frontier(base));
+            schedule_state_t *state = schedule_state_clone(base);
+            ASSERT_NE(nullptr, state);
+            // Split the extras over two appends, the second arriving no earlier than a further advance
+            ASSERT_TRUE(schedule_state_append(state, pcbs + base_count, extra_count / 2));
+            ASSERT_TRUE(schedule_state_append(state, pcbs + base_count + extra_count / 2, extra_count - extra_count / 2));
+            ScheduleResult_t result;
+            ASSERT_TRUE(schedule_state_finish(state, &result));
+            EXPECT_EQ(expected.total_run_time, result.total_run_time) << round;
+            EXPECT_DOUBLE_EQ(expected.average_waiting_time, result.average_waiting_time) << round;
+            EXPECT_DOUBLE_EQ(expected.average_turnaround_time, result.average_turnaround_time) << round;
+            EXPECT_DOUBLE_EQ(expected.average_response_time, result.average_response_time) << round;
+            EXPECT_EQ(expected.context_switches, result.context_switches) << round;
+
+            // The checkpoint itself is untouched and still schedules the base trace alone
+            ASSERT_TRUE(algorithm == SCHEDULE_STATE_FCFS ? first_come_first_serve_view(pcbs, base_count, &expected, &context)
+                                                         : round_robin_view(pcbs, base_count, &expected, quantum, &context));
+            ASSERT_TRUE(schedule_state_finish(base, &result));
+            EXPECT_EQ(expected.total_run_time, result.total_run_time) << round;
+            EXPECT_DOUBLE_EQ(expected.average_waiting_time, result.average_waiting_time) << round;
+            EXPECT_EQ(expected.context_switches, result.context_switches) << round;
+            schedule_state_destroy(state);
+            schedule_state_destroy(base);
+        }
+    }
+    free(scratch);
+}
+
+TEST(schedule_state, RejectsArrivalsBeforeFrontier)
+{
+    ProcessControlBlock_t pcbs[2];
+    create_pcb(0, 0, 10, false, &pcbs[0]);
+    create_pcb(5, 0, 3, false, &pcbs[1]);
+    EXPECT_EQ(nullptr, schedule_state_create(pcbs, 2, SCHEDULE_STATE_RR, 0));
+    schedule_state_t *state = schedule_state_create(pcbs, 1, SCHEDULE_STATE_RR, 4);
+    ASSERT_NE(nullptr, state);
+    ASSERT_TRUE(schedule_state_advance(state, 6));
+    EXPECT_FALSE(schedule_state_append(state, &pcbs[1], 1));
+    pcbs[1].arrival = 6;
+    EXPECT_TRUE(schedule_state_append(state, &pcbs[1], 1));
+
+    ScheduleResult_t result;
+    ASSERT_TRUE(schedule_state_finish(state, &result));
+    EXPECT_EQ((uint64_t)13, result.total_run_time);
+    EXPECT_EQ((uint64_t)13, schedule_state_frontier(state));
+    // Arrivals after the end carry the schedule on
+    pcbs[1].arrival = 20;
+    EXPECT_TRUE(schedule_state_append(state, &pcbs[1], 1));
+    ASSERT_TRUE(schedule_state_finish(state, &result));
+    EXPECT_EQ((uint64_t)23, result.total_run_time);
+    EXPECT_EQ((uint64_t)3, result.context_switches);
+    schedule_state_destroy(state);
+
+    state = schedule_state_create(NULL, 0, SCHEDULE_STATE_FCFS, 0);
+    ASSERT_NE(nullptr, state);
+    EXPECT_FALSE(schedule_state_finish(state, &result));
+    schedule_state_destroy(state);
+}
+
+static int compare_uint32(const void *a, const void *b)
+{
+    uint32_t value_a = *(const uint32_t *)a;
+    uint32_t value_b = *(const uint32_t *)b;
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+TEST(alloc_stats, CountsPhasePeakAndRetainedBytes)
+{
+    AllocPhase_t phase;
+    alloc_stats_begin(&phase, "test");
+    void *kept = malloc(1000);
+    void *temporary = malloc(4000);
+    temporary = realloc(temporary, 8000);
+    free(temporary);
+    alloc_stats_end(&phase);
+    ASSERT_NE(nullptr, kept);
+    EXPECT_EQ((uint64_t)2, phase.delta.allocations);
+    EXPECT_EQ((uint64_t)1, phase.delta.reallocations);
+    EXPECT_EQ((uint64_t)1, phase.delta.frees);
+    // Usable sizes can round the requests up a little
+    EXPECT_GE(phase.delta.live_bytes, 1000);
+    EXPECT_LT(phase.delta.live_bytes, 1100);
+    EXPECT_GE(phase.delta.peak_bytes, 9000);
+    EXPECT_LT(phase.delta.peak_bytes, 9200);
+
+    // The old scheduler helper used to leak a pcb for every arrival it moved
+    dyn_array_t *ready_queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_t *current = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb;
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        dyn_array_push_back(ready_queue, create_pcb(0, 0, 4 - i, false, &pcb));
+    }
+    alloc_stats_begin(&phase, "enqueue");
+    uint64_t time = 0;
+    enqueue_processes(ready_queue, current, &time, compare_burst);
+    alloc_stats_end(&phase);
+    EXPECT_EQ((size_t)4, dyn_array_size(current));
+    EXPECT_LE(phase.delta.live_bytes, 0);
+    dyn_array_destroy(ready_queue);
+    dyn_array_destroy(current);
+    free(kept);
+}
+
+TEST(dyn_array_stats, CountsMovesReallocsAndComparisons)
+{
+    dyn_array_t *array = dyn_array_create(0, sizeof(uint32_t), NULL);
+    ASSERT_NE(nullptr, array);
+    dyn_array_reset_global_stats();
+    // 16 fills the initial capacity, the 17th pushed to the front grows it and shifts the other 16 along
+    for (uint32_t i = 0; i < 17; i++)
+    {
+        ASSERT_TRUE(dyn_array_push_front(array, &i));
+    }
+    uint32_t value = 100;
+    ASSERT_TRUE(dyn_array_insert_sorted(array, &value, compare_uint32));
+    dyn_array_stats_t stats;
+    dyn_array_stats_t global;
+#ifdef DYN_ARRAY_STATS
+    ASSERT_TRUE(dyn_array_get_stats(array, &stats));
+    EXPECT_EQ((uint64_t)(16 * 17 / 2 * sizeof(uint32_t)), stats.bytes_moved);
+    EXPECT_EQ((uint64_t)(18 * sizeof(uint32_t)), stats.bytes_copied);
+    EXPECT_EQ((uint64_t)1, stats.reallocs);
+    EXPECT_EQ((uint64_t)(32 * sizeof(uint32_t)), stats.realloc_bytes);
+    EXPECT_EQ((uint64_t)17, stats.comparisons); // 100 is bigger than all 17, so the search runs off the end
+    EXPECT_EQ((size_t)32, stats.max_capacity);
+    ASSERT_TRUE(dyn_array_get_global_stats(&global));
+    EXPECT_EQ(stats.bytes_moved, global.bytes_moved);
+    EXPECT_EQ(stats.comparisons, global.comparisons);
+#else
+    EXPECT_FALSE(dyn_array_get_stats(array, &stats));
+    EXPECT_EQ((uint64_t)0, stats.bytes_moved);
+    EXPECT_FALSE(dyn_array_get_global_stats(&global));
+#endif
+    dyn_array_destroy(array);
+}
+
+TEST(schedule_view, CountsSortAndQueueOperations)
+{
+    // Out of arrival order so the keys get sorted, every pcb goes through the SJF heap once
+    ProcessControlBlock_t pcbs[4];
+    create_pcb(4, 1, 6, false, &pcbs[0]);
+    create_pcb(0, 1, 2, false, &pcbs[1]);
+    create_pcb(1, 1, 8, false, &pcbs[2]);
+    create_pcb(2, 1, 3, false, &pcbs[3]);
+    size_t scratch_size = schedule_scratch_size(4);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    ScheduleResult_t sr;
+    ScheduleStats_t before;
+    ScheduleStats_t after;
+    bool counted = schedule_get_global_stats(&before);
+    ASSERT_TRUE(shortest_job_first_view(pcbs, 4, &sr, &context));
+    EXPECT_EQ(counted, schedule_get_global_stats(&after));
+#ifdef DYN_ARRAY_STATS
+    EXPECT_GT(after.sort_comparisons - before.sort_comparisons, (uint64_t)1); // The in order check stops at the first pair
+    EXPECT_GE(after.queue_moves - before.queue_moves, (uint64_t)8);           // At least a push and a pop per pcb
+    EXPECT_EQ((after.queue_moves - before.queue_moves) * sizeof(uint32_t), after.queue_bytes_moved - before.queue_bytes_moved);
+#else
+    EXPECT_FALSE(counted);
+    EXPECT_EQ((uint64_t)0, after.queue_moves);
+#endif
+    free(scratch);
+}
+
+TEST(workload_generator, ReproducibleFromSeed)
+{
+    const size_t count = 5000;
+    WorkloadSpec_t spec;
+    workload_spec_init(&spec, 7);
+    spec.order = WORKLOAD_ORDER_SHUFFLED;
+    dyn_array_t *first = generate_workload_dyn_array(&spec, count);
+    dyn_array_t *second = generate_workload_dyn_array(&spec, count);
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    ASSERT_EQ(count, dyn_array_size(first));
+    // Field by field, the padding bytes aren't part of the workload
+    auto same_workload = [count](const dyn_array_t *a, const dyn_array_t *b) {
+        const ProcessControlBlock_t *pcbs_a = (const ProcessControlBlock_t *)dyn_array_export(a);
+        const ProcessControlBlock_t *pcbs_b = (const ProcessControlBlock_t *)dyn_array_export(b);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (pcbs_a[i].arrival != pcbs_b[i].arrival || pcbs_a[i].remaining_burst_time != pcbs_b[i].remaining_burst_time ||
+                pcbs_a[i].priority != pcbs_b[i].priority)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    EXPECT_TRUE(same_workload(first, second));
+
+    // The columns hold the same workload field by field
+    uint64_t *arrivals = (uint64_t *)malloc(count * sizeof(uint64_t));
+    uint64_t *bursts = (uint64_t *)malloc(count * sizeof(uint64_t));
+    uint32_t *priorities = (uint32_t *)malloc(count * sizeof(uint32_t));
+    WorkloadColumns_t columns = {arrivals, bursts, priorities};
+    ASSERT_TRUE(generate_workload_columns(&spec, &columns, count));
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *)dyn_array_export(first);
+    bool sorted = true;
+    for (size_t i = 0; i < count; i++)
+    {
+        ASSERT_EQ(pcbs[i].arrival, arrivals[i]);
+        ASSERT_EQ(pcbs[i].remaining_burst_time, bursts[i]);
+        ASSERT_EQ(pcbs[i].priority, priorities[i]);
+        EXPECT_GE(pcbs[i].remaining_burst_time, spec.min_burst);
+        EXPECT_LE(pcbs[i].remaining_burst_time, spec.max_burst);
+        EXPECT_LT(pcbs[i].priority, spec.priority_levels);
+        sorted = sorted && (i == 0 || pcbs[i - 1].arrival <= pcbs[i].arrival);
+    }
+    EXPECT_FALSE(sorted);
+
+    spec.seed = 8;
+    dyn_array_destroy(second);
+    second = generate_workload_dyn_array(&spec, count);
+    ASSERT_NE(nullptr, second);
+    EXPECT_FALSE(same_workload(first, second));
+    free(arrivals);
+    free(bursts);
+    free(priorities);
+    dyn_array_destroy(first);
+    dyn_array_destroy(second);
+}
+
+TEST(workload_generator, AdversarialCases)
+{
+    const size_t count = 1000;
+    ProcessControlBlock_t pcbs[count];
+    WorkloadSpec_t spec;
+    workload_spec_init(&spec, 1);
+    spec.arrival = WORKLOAD_ARRIVAL_SIMULTANEOUS;
+    spec.burst = WORKLOAD_BURST_CONSTANT;
+    spec.mean_burst = 5;
+    ASSERT_TRUE(generate_workload(&spec, pcbs, count));
+    for (size_t i = 0; i < count; i++)
+    {
+        ASSERT_EQ((uint64_t)0, pcbs[i].arrival);
+        ASSERT_EQ((uint64_t)5, pcbs[i].remaining_burst_time);
+        ASSERT_EQ((uint64_t)5, pcbs[i].total_burst_time);
+    }
+
+    spec.arrival = WORKLOAD_ARRIVAL_BATCHED;
+    spec.batch_size = 10;
+    spec.order = WORKLOAD_ORDER_REVERSED;
+    spec.priority = WORKLOAD_PRIORITY_SKEWED;
+    ASSERT_TRUE(generate_workload(&spec, pcbs, count));
+    size_t top_priority = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        ASSERT_TRUE(i == 0 || pcbs[i - 1].arrival >= pcbs[i].arrival);
+        // Every pcb arrives with the first one generated in its batch of 10, which is written last of the batch
+        size_t generated = count - 1 - i;
+        ASSERT_EQ(pcbs[count - 1 - generated / 10 * 10].arrival, pcbs[i].arrival);
+        top_priority += pcbs[i].priority == 0;
+    }
+    EXPECT_GT(pcbs[0].arrival, (uint64_t)0);
+    EXPECT_GT(top_priority, count / 3);
+
+    spec.min_burst = 10;
+    spec.max_burst = 1;
+    EXPECT_FALSE(generate_workload(&spec, pcbs, count));
+    EXPECT_EQ(nullptr, generate_workload_dyn_array(&spec, count));
+}
+
+TEST(perf_baseline, SummarizesComparesAndRoundTrips)
+{
+    // Median 21, deviations 0 1 1 2 79 so the MAD is 1 and the outlier doesn't matter
+    uint64_t samples[] = {21, 100, 19, 20, 22};
+    PerfMeasurement_t baseline;
+    ASSERT_FALSE(perf_summarize("none", samples, 0, &baseline));
+    ASSERT_TRUE(perf_summarize("scheduler/FCFS/100", samples, 5, &baseline));
+    EXPECT_EQ((size_t)5, baseline.repetitions);
+    EXPECT_DOUBLE_EQ(21, baseline.median_ns);
+    EXPECT_DOUBLE_EQ(1, baseline.mad_ns);
+    EXPECT_DOUBLE_EQ(19, baseline.min_ns);
+    uint64_t even[] = {4, 1, 3, 2};
+    PerfMeasurement_t halves;
+    ASSERT_TRUE(perf_summarize("even", even, 4, &halves));
+    EXPECT_DOUBLE_EQ(2.5, halves.median_ns);
+    EXPECT_DOUBLE_EQ(1, halves.mad_ns);
+
+    // About 10% slower is a regression with a 5% threshold while it is outside the noise, not once the run is noisy
+    PerfMeasurement_t current = baseline;
+    current.median_ns = 23;
+    EXPECT_EQ(PERF_SLOWER, perf_compare(&baseline, &current, 0.05, 1));
+    EXPECT_EQ(PERF_UNCHANGED, perf_compare(&baseline, &current, 0.15, 1));
+    current.mad_ns = 2;
+    EXPECT_EQ(PERF_UNCHANGED, perf_compare(&baseline, &current, 0.05, 1));
+    current.mad_ns = 1;
+    current.median_ns = 18;
+    EXPECT_EQ(PERF_FASTER, perf_compare(&baseline, &current, 0.05, 1));
+
+    const char *path = "perf-baseline-test.json";
+    PerfMeasurement_t written[2] = {baseline, halves};
+    ASSERT_TRUE(perf_baseline_write(path, written, 2));
+    size_t count = 0;
+    PerfMeasurement_t *read = perf_baseline_read(path, &count);
+    ASSERT_NE(nullptr, read);
+    ASSERT_EQ((size_t)2, count);
+    const PerfMeasurement_t *found = perf_find(read, count, "even");
+    ASSERT_NE(nullptr, found);
+    EXPECT_EQ((size_t)4, found->repetitions);
+    EXPECT_DOUBLE_EQ(2.5, found->median_ns);
+    EXPECT_STREQ("scheduler/FCFS/100", read[0].name);
+    EXPECT_DOUBLE_EQ(19, read[0].min_ns);
+    EXPECT_EQ(nullptr, perf_find(read, count, "missing"));
+    free(read);
+    remove(path);
+    EXPECT_EQ(nullptr, perf_baseline_read(path, &count));
+}
+
+TEST(schedule_percentiles, NearestRankBySelection)
+{
+    const size_t count = 2000;
+    PcbMetrics_t *metrics = (PcbMetrics_t *)calloc(count, sizeof(PcbMetrics_t));
+    for (size_t i = 0; i < count; i++)
+    {
+        metrics[i].waiting = (i * 7919) % count + 1; // 1..count shuffled
+        metrics[i].turnaround = 42;
+    }
+    SchedulePercentiles_t percentiles;
+    ASSERT_TRUE(schedule_percentiles(metrics, count, PCB_METRIC_WAITING, NULL, &percentiles));
+    EXPECT_EQ((uint64_t)1000, percentiles.p50);
+    EXPECT_EQ((uint64_t)1800, percentiles.p90);
+    EXPECT_EQ((uint64_t)1980, percentiles.p99);
+    EXPECT_EQ((uint64_t)1998, percentiles.p999);
+    EXPECT_EQ((uint64_t)2000, percentiles.max);
+
+    ASSERT_TRUE(schedule_percentiles(metrics, count, PCB_METRIC_TURNAROUND, NULL, &percentiles));
+    EXPECT_EQ((uint64_t)42, percentiles.p50);
+    EXPECT_EQ((uint64_t)42, percentiles.max);
+    ASSERT_TRUE(schedule_percentiles(metrics, 1, PCB_METRIC_WAITING, NULL, &percentiles));
+    EXPECT_EQ(metrics[0].waiting, percentiles.p50);
+    EXPECT_EQ(metrics[0].waiting, percentiles.max);
+
+    EXPECT_FALSE(schedule_percentiles(NULL, count, PCB_METRIC_WAITING, NULL, &percentiles));
+    EXPECT_FALSE(schedule_percentiles(metrics, 0, PCB_METRIC_WAITING, NULL, &percentiles));
+    EXPECT_FALSE(schedule_percentiles(metrics, count, PCB_METRIC_COUNT, NULL, &percentiles));
+    free(metrics);
+}
+
+TEST(schedule_timeline, MergesAndWraps)
+{
+    EXPECT_EQ(nullptr, schedule_timeline_create(0));
+    ScheduleTimeline_t *timeline = schedule_timeline_create(3);
+    ASSERT_NE(nullptr, timeline);
+    schedule_timeline_record(timeline, 1, 0, 0, 4);
+    schedule_timeline_record(timeline, 1, 0, 4, 8); // Back to back, merged
+    schedule_timeline_record(timeline, 2, 0, 8, 9);
+    schedule_timeline_record(timeline, 1, 0, 10, 12); // Gap, not merged
+    ASSERT_EQ((size_t)3, timeline->size);
+    EXPECT_EQ((uint64_t)8, schedule_timeline_at(timeline, 0).end);
+    schedule_timeline_record(timeline, 3, 0, 12, 13); // Full, drops the oldest
+    EXPECT_EQ((size_t)3, timeline->size);
+    EXPECT_EQ((uint64_t)1, timeline->dropped);
+    EXPECT_EQ((uint32_t)2, schedule_timeline_at(timeline, 0).pid);
+    EXPECT_EQ((uint32_t)3, schedule_timeline_at(timeline, 2).pid);
+    EXPECT_EQ((uint64_t)0, schedule_timeline_at(timeline, 3).end);
+    schedule_timeline_clear(timeline);
+    EXPECT_EQ((size_t)0, timeline->size);
+    schedule_timeline_destroy(timeline);
+}
+
+TEST(schedule_timeline, EscapesTheName)
+{
+    char escaped[64];
+    json_escape("a\"b\\c\n", escaped);
+    EXPECT_STREQ("a\\\"b\\\\c\\u000a", escaped);
+
+    ScheduleTimeline_t *timeline = schedule_timeline_create(2);
+    ASSERT_NE(nullptr, timeline);
+    schedule_timeline_record(timeline, 0, 0, 0, 1);
+    const char *trace = "timeline_name.json";
+    ASSERT_TRUE(schedule_timeline_write_chrome_trace(timeline, "RR \"q=2\"", trace));
+    FILE *fp = fopen(trace, "r");
+    ASSERT_NE(nullptr, fp);
+    char contents[512];
+    size_t length = fread(contents, 1, sizeof(contents) - 1, fp);
+    contents[length] = '\0';
+    fclose(fp);
+    remove(trace);
+    EXPECT_NE(nullptr, strstr(contents, "\"args\":{\"name\":\"RR \\\"q=2\\\"\"}"));
+    schedule_timeline_destroy(timeline);
+}
+
+TEST(schedule_timeline, RecordsScheduleAsChromeTrace)
+{
+    dyn_array_t *array = load_process_control_blocks("../pcb.bin");
+    ASSERT_NE(nullptr, array);
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *)dyn_array_export(array);
+    size_t count = dyn_array_size(array);
+    size_t scratch_size = schedule_scratch_size(count);
+    void *scratch = malloc(scratch_size);
+    ScheduleContext_t context;
+    schedule_context_init(&context, scratch, scratch_size);
+    context.timeline = schedule_timeline_create(64);
+
+    // Every algorithm keeps the cpu busy for exactly the total burst between the first arrival and the end of the run
+    const char *algorithms[] = {"FCFS", "SJF", "RR", "SRTF"};
+    for (const char *algorithm : algorithms)
+    {
+        schedule_timeline_clear(context.timeline);
+        ScheduleResult_t result;
+        ASSERT_TRUE(run_schedule_view(algorithm, pcbs, count, &result, 2, &context));
+        uint64_t busy = 0;
+        for (size_t i = 0; i < context.timeline->size; i++)
+        {
+            ScheduleSegment_t segment = schedule_timeline_at(context.timeline, i);
+            busy += segment.end - segment.start;
+            EXPECT_LT(segment.pid, count);
+            if (i > 0)
+            {
+                EXPECT_GE(segment.start, schedule_timeline_at(context.timeline, i - 1).end) << algorithm;
+            }
+        }
+        EXPECT_EQ((uint64_t)50, busy) << algorithm;
+        EXPECT_EQ(result.total_run_time, schedule_timeline_at(context.timeline, context.timeline->size - 1).end);
+    }
+    // FCFS runs each pcb in one piece
+    ScheduleResult_t result;
+    schedule_timeline_clear(context.timeline);
+    ASSERT_TRUE(first_come_first_serve_view(pcbs, count, &result, &context));
+    EXPECT_EQ(count, context.timeline->size);
+
+    const char *trace = "timeline_test.json";
+    ASSERT_TRUE(schedule_timeline_write_chrome_trace(context.timeline, "FCFS", trace));
+    FILE *fp = fopen(trace, "r");
+    ASSERT_NE(nullptr, fp);
+    char contents[4096];
+    size_t length = fread(contents, 1, sizeof(contents) - 1, fp);
+    contents[length] = '\0';
+    fclose(fp);
+    remove(trace);
+    EXPECT_NE(nullptr, strstr(contents, "\"traceEvents\""));
+    EXPECT_NE(nullptr, strstr(contents, "\"ph\":\"X\""));
+    EXPECT_FALSE(schedule_timeline_write_chrome_trace(context.timeline, "FCFS", "missing/timeline.json"));
+
+    schedule_timeline_destroy(context.timeline);
+    free(scratch);
+    dyn_array_destroy(array);
+}
+
+TEST(shortest_remaining_time_first, ZeroBurstFinishesImmediately)
+{
+    ProcessControlBlock_t pcbs[3];
+    create_pcb(0, 1, 4, false, &pcbs[0]);
+    create_pcb(1, 1, 0, false, &pcbs[1]);
+    create_pcb(2, 1, 2, false, &pcbs[2]);
+    dyn_array_t *ready_queue = dyn_array_import(pcbs, 3, sizeof(ProcessControlBlock_t), NULL);
+    ScheduleResult_t result;
+    EXPECT_TRUE(shortest_remaining_time_first(ready_queue, &result));
+    EXPECT_EQ((unsigned long)6, result.total_run_time);
+    EXPECT_DOUBLE_EQ((double)2 / 3, result.average_waiting_time);
+    dyn_array_destroy(ready_queue);
+}
+
+/*
+ * Results sink
+ */
+TEST(append_schedule_record, AppendsOneLinePerRun)
+{
+    const char *results = "append-test-results.jsonl";
+    remove(results);
+    ScheduleResult_t sr;
+    sr.average_waiting_time = 16;
+    sr.average_turnaround_time = 28.5;
+    sr.total_run_time = 50;
+    char algorithm[] = "first_come_first_serve";
+    ScheduleRecord_t record = {canonical_algorithm(algorithm), 0, "../pcb.bin", 0x0123456789abcdefULL, 4, &sr};
+    EXPECT_TRUE(append_schedule_record(results, &record));
+    record.algorithm = "RR";
+    record.quantum = 5;
+    EXPECT_TRUE(append_schedule_record(results, &record));
+
+    FILE *fp = fopen(results, "r");
+    ASSERT_NE(nullptr, fp);
+    char line[1024];
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_NE(nullptr, strstr(line, "\"algorithm\":\"FCFS\""));
+    EXPECT_NE(nullptr, strstr(line, "\"total_run_time\":50"));
+    EXPECT_NE(nullptr, strstr(line, "\"input_hash\":\"0123456789abcdef\""));
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_NE(nullptr, strstr(line, "\"quantum\":5"));
+    EXPECT_EQ(nullptr, fgets(line, sizeof(line), fp));
+    fclose(fp);
+    remove(results);
+
+    EXPECT_FALSE(append_schedule_record(results, NULL));
+}
+
+TEST(print_to_readme, WritesGivenPath)
+{
+    const char *readme = "print_to_readme_test.md";
+    FILE *fp = fopen(readme, "w");
+    ASSERT_NE(nullptr, fp);
+    fputs("# Title\nAverage Waiting Time: 11.750000\nAverage Turnaround Time: 24.250000\nTotal Run time: 50\n\n----\nSchedule Results\n", fp);
+    fclose(fp);
+
+    ScheduleResult_t result;
+    memset(&result, 0, sizeof(result));
+    result.average_waiting_time = 1.5f;
+    result.average_turnaround_time = 2.5f;
+    result.total_run_time = 10;
+    EXPECT_TRUE(print_to_readme(readme, &result, 2));
+    fp = fopen(readme, "r");
+    ASSERT_NE(nullptr, fp);
+    char line[128];
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_STREQ("# Title\n", line);
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_STREQ("Average Waiting Time: 1.500000\n", line);
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_STREQ("Average Turnaround Time: 2.500000\n", line);
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_STREQ("Total Run time: 10\n", line);
+    // The lines after the block come through unchanged even though the new block is shorter than the old one
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_STREQ("\n", line);
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_STREQ("----\n", line);
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), fp));
+    EXPECT_STREQ("Schedule Results\n", line);
+    EXPECT_EQ(nullptr, fgets(line, sizeof(line), fp));
+    fclose(fp);
+    remove(readme);
+
+    EXPECT_FALSE(print_to_readme(NULL, &result, 2));
+    EXPECT_FALSE(print_to_readme("missing/readme.md", &result, 2));
+}
+
+TEST(parse_quantum_range, ExpandsRanges)
+{
+    size_t count = 0;
+    size_t *quanta = parse_quantum_range("1:256:x2", &count);
+    ASSERT_NE(nullptr, quanta);
+    ASSERT_EQ((size_t)9, count);
+    EXPECT_EQ((size_t)1, quanta[0]);
+    EXPECT_EQ((size_t)256, quanta[8]);
+    free(quanta);
+
+    quanta = parse_quantum_range("2:9:+3", &count);
+    ASSERT_NE(nullptr, quanta);
+    ASSERT_EQ((size_t)3, count);
+    EXPECT_EQ((size_t)8, quanta[2]);
+    free(quanta);
+
+    quanta = parse_quantum_range("4:6", &count);
+    ASSERT_NE(nullptr, quanta);
+    EXPECT_EQ((size_t)3, count);
+    free(quanta);
+
+    EXPECT_EQ(nullptr, parse_quantum_range(NULL, &count));
+    EXPECT_EQ(nullptr, parse_quantum_range("0:4", &count));
+    EXPECT_EQ(nullptr, parse_quantum_range("8:4", &count));
+    EXPECT_EQ(nullptr, parse_quantum_range("1:8:x1", &count));
+    EXPECT_EQ(nullptr, parse_quantum_range("1:8:-1", &count));
+    EXPECT_EQ(nullptr, parse_quantum_range("1:8:2y", &count));
+    EXPECT_EQ(nullptr, parse_quantum_range("1:8x", &count));
+}
+
 class GradeEnvironment : public testing::Environment
 {
 public: